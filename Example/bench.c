@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tesselator.h"
+
+// Command line benchmark for the tesselator core.  It runs a few synthetic
+// workloads and reports the best time of several runs for each.
+
+struct Workload
+{
+	const char* name;
+	float* verts;
+	int* counts;		// vertices per contour
+	int ncontours;
+	int windingRule;
+};
+
+static float frand(unsigned int* seed)
+{
+	*seed = *seed * 1664525u + 1013904223u;
+	return (float)(*seed >> 8) / (float)(1 << 24);
+}
+
+// A single self-intersecting polygon with random vertices; produces lots of
+// intersections and a wide sweep line.
+static void makeRandom(struct Workload* w, int n)
+{
+	unsigned int seed = 1;
+	int i;
+	w->name = "random polygon";
+	w->verts = (float*)malloc(sizeof(float)*2*n);
+	w->counts = (int*)malloc(sizeof(int));
+	for (i = 0; i < n; ++i)
+	{
+		w->verts[i*2] = frand(&seed) * 1000.0f;
+		w->verts[i*2+1] = frand(&seed) * 1000.0f;
+	}
+	w->counts[0] = n;
+	w->ncontours = 1;
+	w->windingRule = TESS_WINDING_ODD;
+}
+
+// Many small overlapping circles, typical of text and map data.
+static void makeCircles(struct Workload* w, int n, int segs)
+{
+	unsigned int seed = 7;
+	int i, j;
+	w->name = "overlapping circles";
+	w->verts = (float*)malloc(sizeof(float)*2*n*segs);
+	w->counts = (int*)malloc(sizeof(int)*n);
+	for (i = 0; i < n; ++i)
+	{
+		const float cx = frand(&seed) * 1000.0f;
+		const float cy = frand(&seed) * 1000.0f;
+		const float r = 5.0f + frand(&seed) * 20.0f;
+		for (j = 0; j < segs; ++j)
+		{
+			const float a = (float)j / (float)segs * 3.14159265f * 2.0f;
+			w->verts[(i*segs+j)*2] = cx + cosf(a) * r;
+			w->verts[(i*segs+j)*2+1] = cy + sinf(a) * r;
+		}
+		w->counts[i] = segs;
+	}
+	w->ncontours = n;
+	w->windingRule = TESS_WINDING_NONZERO;
+}
+
+// A large star shaped polygon with a hole; no intersections, lots of
+// monotone regions to triangulate.
+static void makeStar(struct Workload* w, int n)
+{
+	int i;
+	w->name = "star with hole";
+	w->verts = (float*)malloc(sizeof(float)*2*n*2);
+	w->counts = (int*)malloc(sizeof(int)*2);
+	for (i = 0; i < n; ++i)
+	{
+		const float a = (float)i / (float)n * 3.14159265f * 2.0f;
+		const float r = (i & 1) ? 1000.0f : 600.0f;
+		w->verts[i*2] = cosf(a) * r;
+		w->verts[i*2+1] = sinf(a) * r;
+		w->verts[(n+i)*2] = cosf(-a) * 300.0f;
+		w->verts[(n+i)*2+1] = sinf(-a) * 300.0f;
+	}
+	w->counts[0] = n;
+	w->counts[1] = n;
+	w->ncontours = 2;
+	w->windingRule = TESS_WINDING_ODD;
+}
+
+// Regression check for clipping: three overlapping contours, clipped so that
+// their outside parts run along the rectangle and some vertices land on the
+// edges of the other contours.  The output has to cover exactly the area
+// where the winding rule holds inside the rectangle.
+static int checkClipRect(void)
+{
+	static const float c0[] = { 10,5, 7,2, 11,6, 5,8, 13,8, 1,5, 10,11, 2,16, 3,10, 6,7 };
+	static const float c1[] = { 14,7, 3,16, 19,2, 19,17, 8,14, 10,13, 15,17, 7,16, 6,9, 11,0, 13,11 };
+	static const float c2[] = { 3,10, 10,3, 18,7, 16,3, 17,1, 7,2, 19,16, 0,4 };
+	static const float normal[3] = { 0, 0, 1 };
+	const float expected = 35.254f;
+	TESStesselator* tess;
+	const float* verts;
+	const int* elems;
+	double area = 0.0;
+	int i, nelems;
+
+	tess = tessNewTess(NULL);
+	if (!tess)
+		return 0;
+	tessSetClipRect(tess, 4.3f, 3.7f, 15.1f, 12.9f);
+	tessAddContour(tess, 2, c0, sizeof(float)*2, 10);
+	tessAddContour(tess, 2, c1, sizeof(float)*2, 11);
+	tessAddContour(tess, 2, c2, sizeof(float)*2, 8);
+	if (!tessTesselate(tess, TESS_WINDING_ABS_GEQ_TWO, TESS_POLYGONS, 3, 2, normal))
+	{
+		tessDeleteTess(tess);
+		return 0;
+	}
+
+	verts = tessGetVertices(tess);
+	elems = tessGetElements(tess);
+	nelems = tessGetElementCount(tess);
+	for (i = 0; i < nelems; ++i)
+	{
+		const float* a = &verts[elems[i*3]*2];
+		const float* b = &verts[elems[i*3+1]*2];
+		const float* c = &verts[elems[i*3+2]*2];
+		area += 0.5 * ((b[0]-a[0])*(c[1]-a[1]) - (c[0]-a[0])*(b[1]-a[1]));
+	}
+	tessDeleteTess(tess);
+
+	printf("%-24s %8.3f area, expected %.3f\n", "clip rectangle", area, expected);
+	return fabs(area - expected) < 0.01;
+}
+
+static double runWorkload(const struct Workload* w, int* nelems)
+{
+	TESStesselator* tess;
+	clock_t t0, t1;
+	const float* v = w->verts;
+	int i;
+
+	tess = tessNewTess(NULL);
+	if (!tess)
+		return -1.0;
+
+	t0 = clock();
+	for (i = 0; i < w->ncontours; ++i)
+	{
+		tessAddContour(tess, 2, v, sizeof(float)*2, w->counts[i]);
+		v += w->counts[i]*2;
+	}
+	if (!tessTesselate(tess, w->windingRule, TESS_POLYGONS, 3, 2, 0))
+	{
+		tessDeleteTess(tess);
+		return -1.0;
+	}
+	t1 = clock();
+
+	*nelems = tessGetElementCount(tess);
+	tessDeleteTess(tess);
+
+	return (double)(t1 - t0) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[])
+{
+	struct Workload works[3];
+	int nworks = 3;
+	int runs = 10;
+	int i, j;
+
+	if (argc > 1)
+		runs = atoi(argv[1]);
+	if (runs < 1)
+		runs = 1;
+
+	if (!checkClipRect())
+	{
+		printf("clip rectangle check failed\n");
+		return 1;
+	}
+
+	makeRandom(&works[0], 400);
+	makeCircles(&works[1], 2000, 32);
+	makeStar(&works[2], 5000);
+
+	for (i = 0; i < nworks; ++i)
+	{
+		double best = -1.0;
+		int nelems = 0;
+		for (j = 0; j < runs; ++j)
+		{
+			const double t = runWorkload(&works[i], &nelems);
+			if (t < 0.0)
+			{
+				printf("%-24s failed\n", works[i].name);
+				break;
+			}
+			if (best < 0.0 || t < best)
+				best = t;
+		}
+		if (best >= 0.0)
+			printf("%-24s %8d triangles %10.3f ms\n", works[i].name, nelems, best);
+		free(works[i].verts);
+		free(works[i].counts);
+	}
+
+	return 0;
+}
@@ -0,0 +1,668 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nanosvg.h"
+#include "tesselator.h"
+
+// Command line tesselation tool.  Runs tessTesselate() on the contours of an
+// SVG file or a binary contour file without a window, prints the phase timings
+// and memory use, and optionally writes the output as OBJ or binary.
+// It also replays the traces recorded with tessBeginCapture(), timing each
+// recorded tessTesselate() call again and checking that the output matches.
+// The phases of all runs can be written as a Chrome trace (see tessNewTracer()).
+//
+// Binary contour file (native endianness):
+//   char magic[4] = "TESC"
+//   int vertexSize                  (2 or 3)
+//   int contourCount
+//   int counts[contourCount]        (vertices per contour)
+//   float coords[sum(counts) * vertexSize]
+//
+// Binary output file (native endianness):
+//   char magic[4] = "TESO"
+//   int elementType, polySize, vertexSize, vertexCount, elementCount
+//   float vertices[vertexCount * vertexSize]
+//   int vertexIndices[vertexCount]
+//   int elements[elementCount * stride]  (stride is polySize, polySize*2 or 2, see TessElementType)
+
+struct Input
+{
+	float* verts;
+	int* counts;
+	int ncontours;
+	int vertexSize;
+};
+
+// Allocator which keeps track of the memory in use.  Each block has a header
+// which stores its size.
+struct MemStats
+{
+	size_t current;
+	size_t peak;
+	int allocs;
+};
+
+#define MEM_HEADER 16
+
+static void* countAlloc(void* userData, unsigned int size)
+{
+	struct MemStats* mem = (struct MemStats*)userData;
+	unsigned char* ptr = (unsigned char*)malloc(size + MEM_HEADER);
+	if (!ptr) return NULL;
+	*(size_t*)ptr = size;
+	mem->current += size;
+	if (mem->current > mem->peak)
+		mem->peak = mem->current;
+	mem->allocs++;
+	return ptr + MEM_HEADER;
+}
+
+static void countFree(void* userData, void* ptr)
+{
+	struct MemStats* mem = (struct MemStats*)userData;
+	unsigned char* p;
+	if (!ptr) return;
+	p = (unsigned char*)ptr - MEM_HEADER;
+	mem->current -= *(size_t*)p;
+	free(p);
+}
+
+static void* countRealloc(void* userData, void* ptr, unsigned int size)
+{
+	struct MemStats* mem = (struct MemStats*)userData;
+	unsigned char* p = ptr ? (unsigned char*)ptr - MEM_HEADER : NULL;
+	size_t old = p ? *(size_t*)p : 0;
+	p = (unsigned char*)realloc(p, size + MEM_HEADER);
+	if (!p) return NULL;
+	*(size_t*)p = size;
+	mem->current += size - old;
+	if (mem->current > mem->peak)
+		mem->peak = mem->current;
+	mem->allocs++;
+	return p + MEM_HEADER;
+}
+
+static void initAlloc(TESSalloc* ma, struct MemStats* mem)
+{
+	memset(mem, 0, sizeof(*mem));
+	memset(ma, 0, sizeof(*ma));
+	ma->memalloc = countAlloc;
+	ma->memrealloc = countRealloc;
+	ma->memfree = countFree;
+	ma->userData = (void*)mem;
+}
+
+static int hasSuffix(const char* str, const char* suffix)
+{
+	const size_t n = strlen(str), m = strlen(suffix);
+	return n >= m && strcmp(str + n - m, suffix) == 0;
+}
+
+static int loadSvg(struct Input* in, const char* path)
+{
+	struct SVGPath* plist;
+	struct SVGPath* it;
+	int nverts = 0, i;
+	float* v;
+
+	plist = svgParseFromFile(path);
+	if (!plist)
+		return 0;
+	for (it = plist; it != NULL; it = it->next)
+	{
+		nverts += it->npts;
+		in->ncontours++;
+	}
+	in->vertexSize = 2;
+	in->verts = (float*)malloc(sizeof(float)*2*(nverts > 0 ? nverts : 1));
+	in->counts = (int*)malloc(sizeof(int)*(in->ncontours > 0 ? in->ncontours : 1));
+	if (!in->verts || !in->counts)
+	{
+		svgDelete(plist);
+		return 0;
+	}
+	v = in->verts;
+	for (i = 0, it = plist; it != NULL; it = it->next, ++i)
+	{
+		memcpy(v, it->pts, sizeof(float)*2*it->npts);
+		v += it->npts*2;
+		in->counts[i] = it->npts;
+	}
+	svgDelete(plist);
+	return 1;
+}
+
+static int loadContours(struct Input* in, const char* path)
+{
+	FILE* fp;
+	char magic[4];
+	int i, nverts = 0, ok = 0;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return 0;
+	if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, "TESC", 4) != 0)
+		goto out;
+	if (fread(&in->vertexSize, sizeof(int), 1, fp) != 1 || fread(&in->ncontours, sizeof(int), 1, fp) != 1)
+		goto out;
+	if ((in->vertexSize != 2 && in->vertexSize != 3) || in->ncontours < 0)
+		goto out;
+	in->counts = (int*)malloc(sizeof(int)*(in->ncontours > 0 ? in->ncontours : 1));
+	if (!in->counts || fread(in->counts, sizeof(int), in->ncontours, fp) != (size_t)in->ncontours)
+		goto out;
+	for (i = 0; i < in->ncontours; ++i)
+	{
+		if (in->counts[i] < 0)
+			goto out;
+		nverts += in->counts[i];
+	}
+	in->verts = (float*)malloc(sizeof(float)*in->vertexSize*(nverts > 0 ? nverts : 1));
+	if (!in->verts || fread(in->verts, sizeof(float)*in->vertexSize, nverts, fp) != (size_t)nverts)
+		goto out;
+	ok = 1;
+out:
+	fclose(fp);
+	return ok;
+}
+
+static int writeObj(TESStesselator* tess, const char* path, int elementType, int polySize, int vertexSize)
+{
+	const float* verts = tessGetVertices(tess);
+	const TESSindex* elems = tessGetElements(tess);
+	const int nverts = tessGetVertexCount(tess);
+	const int nelems = tessGetElementCount(tess);
+	const int stride = elementType == TESS_CONNECTED_POLYGONS ? polySize*2 : polySize;
+	FILE* fp;
+	int i, j;
+
+	fp = fopen(path, "w");
+	if (!fp)
+		return 0;
+	for (i = 0; i < nverts; ++i)
+	{
+		const float* v = &verts[i*vertexSize];
+		fprintf(fp, "v %g %g %g\n", v[0], v[1], vertexSize > 2 ? v[2] : 0.0f);
+	}
+	for (i = 0; i < nelems; ++i)
+	{
+		if (elementType == TESS_BOUNDARY_CONTOURS)
+		{
+			const TESSindex base = elems[i*2];
+			const TESSindex count = elems[i*2+1];
+			fprintf(fp, "l");
+			for (j = 0; j < count; ++j)
+				fprintf(fp, " %d", base + j + 1);
+			fprintf(fp, " %d\n", base + 1);
+		}
+		else
+		{
+			const TESSindex* poly = &elems[i*stride];
+			fprintf(fp, "f");
+			for (j = 0; j < polySize && poly[j] != TESS_UNDEF; ++j)
+				fprintf(fp, " %d", poly[j] + 1);
+			fprintf(fp, "\n");
+		}
+	}
+	return fclose(fp) == 0;
+}
+
+static int writeBinary(TESStesselator* tess, const char* path, int elementType, int polySize, int vertexSize)
+{
+	const int nverts = tessGetVertexCount(tess);
+	const int nelems = tessGetElementCount(tess);
+	int stride, header[5];
+	FILE* fp;
+	int ok;
+
+	if (elementType == TESS_BOUNDARY_CONTOURS)
+		stride = 2;
+	else if (elementType == TESS_CONNECTED_POLYGONS)
+		stride = polySize*2;
+	else
+		stride = polySize;
+
+	header[0] = elementType;
+	header[1] = polySize;
+	header[2] = vertexSize;
+	header[3] = nverts;
+	header[4] = nelems;
+
+	fp = fopen(path, "wb");
+	if (!fp)
+		return 0;
+	ok = fwrite("TESO", 1, 4, fp) == 4
+		&& fwrite(header, sizeof(int), 5, fp) == 5
+		&& fwrite(tessGetVertices(tess), sizeof(float)*vertexSize, nverts, fp) == (size_t)nverts
+		&& fwrite(tessGetVertexIndices(tess), sizeof(TESSindex), nverts, fp) == (size_t)nverts
+		&& fwrite(tessGetElements(tess), sizeof(TESSindex)*stride, nelems, fp) == (size_t)nelems;
+	return fclose(fp) == 0 && ok;
+}
+
+static int parseWinding(const char* str)
+{
+	if (strcmp(str, "odd") == 0) return TESS_WINDING_ODD;
+	if (strcmp(str, "nonzero") == 0) return TESS_WINDING_NONZERO;
+	if (strcmp(str, "positive") == 0) return TESS_WINDING_POSITIVE;
+	if (strcmp(str, "negative") == 0) return TESS_WINDING_NEGATIVE;
+	if (strcmp(str, "absgeq2") == 0) return TESS_WINDING_ABS_GEQ_TWO;
+	return -1;
+}
+
+static int parseElementType(const char* str)
+{
+	if (strcmp(str, "polygons") == 0) return TESS_POLYGONS;
+	if (strcmp(str, "connected") == 0) return TESS_CONNECTED_POLYGONS;
+	if (strcmp(str, "contours") == 0) return TESS_BOUNDARY_CONTOURS;
+	return -1;
+}
+
+static void usage(void)
+{
+	printf("usage: tesstool [options] input.svg|input.bin\n");
+	printf("  -w rule     winding rule: odd, nonzero, positive, negative, absgeq2 (odd)\n");
+	printf("  -e type     element type: polygons, connected, contours (polygons)\n");
+	printf("  -p size     max vertices per polygon (3)\n");
+	printf("  -cdt        refine with constrained Delaunay triangulation\n");
+	printf("  -a          use adaptive bucket sizes (TESSalloc::adaptiveBuckets)\n");
+	printf("  -g          output the polygons grouped by region (TESS_GROUPED_OUTPUT)\n");
+	printf("  -n count    number of runs (1)\n");
+	printf("  -o file     write the output of the last run, .obj as OBJ, otherwise binary\n");
+	printf("  -c file     capture the calls of the first run into a trace file\n");
+	printf("  -t file     write the phase timeline of the runs as Chrome trace JSON\n");
+	printf("A trace file as input is replayed with the options it contains, only -n applies.\n");
+}
+
+// Trace records, see Source/capture.h.
+enum TraceRecord
+{
+	TRACE_CONTOUR = 1,
+	TRACE_OFFSET_CONTOUR,
+	TRACE_PATH,
+	TRACE_OPTION,
+	TRACE_CLIP_RECT,
+	TRACE_TESSELATE,
+	TRACE_UNRECORDED,
+	TRACE_TRUNCATED,
+};
+
+struct TraceCall
+{
+	float recordedMs;
+	int recordedResult, recordedVerts, recordedElems;
+	int result, verts, elems;
+	double best, sum;
+};
+
+static int isTrace(const char* path)
+{
+	char magic[4];
+	FILE* fp = fopen(path, "rb");
+	int ok;
+	if (!fp)
+		return 0;
+	ok = fread(magic, 1, 4, fp) == 4 && memcmp(magic, "TESR", 4) == 0;
+	fclose(fp);
+	return ok;
+}
+
+// Runs the calls of a trace on a new tesselator.  Returns 0 if the trace is broken.
+static int replayRun(TESSalloc* ma, const unsigned char* buf, long size, struct TraceCall* calls, int ncalls,
+					 int* unrecorded, int* truncated)
+{
+	TESStesselator* tess;
+	const unsigned char* p = buf + 8;
+	const unsigned char* end = buf + size;
+	int call = 0;
+
+	tess = tessNewTess(ma);
+	if (!tess)
+		return 0;
+	tessSetOption(tess, TESS_PHASE_TIMINGS, 1);
+
+	while (p + 8 <= end)
+	{
+		const int* rec = (const int*)p;
+		const int type = rec[0];
+		const int bytes = rec[1];
+		const int* ip = rec + 2;
+		const float* fp = (const float*)(rec + 2);
+		if (bytes < 0 || bytes > end - (p + 8))
+			break;
+		switch (type)
+		{
+		case TRACE_CONTOUR:
+			tessAddContour(tess, ip[0], fp + 2, sizeof(float)*ip[0], ip[1]);
+			break;
+		case TRACE_OFFSET_CONTOUR:
+			tessAddOffsetContour(tess, ip[0], fp + 6, sizeof(float)*ip[0], ip[1],
+								 fp[3], ip[2], fp[4], fp[5]);
+			break;
+		case TRACE_PATH:
+			tessAddPath(tess, (const unsigned char*)(ip + 3), ip[0],
+						fp + 3 + (ip[0] + 3) / 4, fp[2]);
+			break;
+		case TRACE_OPTION:
+			tessSetOption(tess, ip[0], ip[1]);
+			break;
+		case TRACE_CLIP_RECT:
+			tessSetClipRect(tess, fp[0], fp[1], fp[2], fp[3]);
+			break;
+		case TRACE_TESSELATE:
+			if (call < ncalls)
+			{
+				struct TraceCall* c = &calls[call++];
+				const TESSstats* stats;
+				double ms;
+				c->recordedResult = ip[8];
+				c->recordedVerts = ip[9];
+				c->recordedElems = ip[10];
+				c->recordedMs = fp[11] * 1000.0f;
+				c->result = tessTesselate(tess, ip[0], ip[1], ip[2], ip[3], ip[4] ? fp + 5 : NULL);
+				c->verts = tessGetVertexCount(tess);
+				c->elems = tessGetElementCount(tess);
+				stats = tessGetStats(tess);
+				ms = (stats->projectTime + stats->sweepTime + stats->tessellateTime + stats->outputTime) * 1000.0;
+				if (c->best < 0.0 || ms < c->best)
+					c->best = ms;
+				c->sum += ms;
+			}
+			break;
+		case TRACE_UNRECORDED:
+			*unrecorded = 1;
+			break;
+		case TRACE_TRUNCATED:
+			*truncated = 1;
+			break;
+		}
+		p += 8 + bytes;
+	}
+
+	tessDeleteTess(tess);
+	return p == end;
+}
+
+static int replayTrace(const char* path, int runs)
+{
+	struct MemStats mem;
+	TESSalloc ma;
+	struct TraceCall* calls = NULL;
+	unsigned char* buf = NULL;
+	const unsigned char* p;
+	FILE* fp;
+	long size;
+	int ncalls = 0, unrecorded = 0, truncated = 0;
+	int i, j, ret = 1;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return 1;
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = (unsigned char*)malloc(size > 0 ? size : 1);
+	if (!buf || size < 8 || fread(buf, 1, size, fp) != (size_t)size || ((const int*)buf)[1] != 1)
+	{
+		printf("Could not read trace %s\n", path);
+		fclose(fp);
+		goto out;
+	}
+	fclose(fp);
+
+	for (p = buf + 8; p + 8 <= buf + size; p += 8 + ((const int*)p)[1])
+	{
+		if (((const int*)p)[1] < 0)
+			break;
+		if (((const int*)p)[0] == TRACE_TESSELATE)
+			ncalls++;
+	}
+	calls = (struct TraceCall*)calloc(ncalls > 0 ? ncalls : 1, sizeof(struct TraceCall));
+	if (!calls)
+		goto out;
+	for (i = 0; i < ncalls; ++i)
+		calls[i].best = -1.0;
+
+	initAlloc(&ma, &mem);
+	for (j = 0; j < runs; ++j)
+	{
+		if (!replayRun(&ma, buf, size, calls, ncalls, &unrecorded, &truncated))
+		{
+			printf("Trace %s is broken\n", path);
+			goto out;
+		}
+	}
+
+	printf("%s: %d tesselate calls, %d runs\n", path, ncalls, runs);
+	if (unrecorded)
+		printf("Warning: the trace has input which was not recorded, the results may differ.\n");
+	if (truncated)
+		printf("Warning: the trace is truncated.\n");
+	printf("%6s %12s %10s %10s %10s %10s\n", "call", "recorded ms", "best ms", "mean ms", "vertices", "elements");
+	for (i = 0; i < ncalls; ++i)
+	{
+		const struct TraceCall* c = &calls[i];
+		const int same = c->result == c->recordedResult && c->verts == c->recordedVerts && c->elems == c->recordedElems;
+		printf("%6d %12.3f %10.3f %10.3f %10d %10d%s\n", i, c->recordedMs, c->best, c->sum / runs,
+			   c->verts, c->elems, same ? "" : " (output differs)");
+	}
+	printf("Memory: %.1f kB peak, %d allocations per run\n", mem.peak/1024.0, mem.allocs / runs);
+	ret = 0;
+
+out:
+	free(calls);
+	free(buf);
+	return ret;
+}
+
+// Phase times of one run in milliseconds.
+enum Phase { PHASE_ADD, PHASE_PROJECT, PHASE_SWEEP, PHASE_TESSELLATE, PHASE_OUTPUT, PHASE_TOTAL, PHASE_COUNT };
+static const char* phaseNames[PHASE_COUNT] = { "add contours", "project", "sweep", "tesselate", "output", "total" };
+
+int main(int argc, char* argv[])
+{
+	struct Input in;
+	struct MemStats mem;
+	TESSalloc ma;
+	TESStesselator* tess = NULL;
+	const TESSstats* stats;
+	const char* inPath = NULL;
+	const char* outPath = NULL;
+	const char* capturePath = NULL;
+	const char* tracePath = NULL;
+	TESStracer* tracer = NULL;
+	int windingRule = TESS_WINDING_ODD;
+	int elementType = TESS_POLYGONS;
+	int polySize = 3;
+	int cdt = 0;
+	int adaptive = 0;
+	int grouped = 0;
+	int runs = 1;
+	double best[PHASE_COUNT], sum[PHASE_COUNT], t[PHASE_COUNT];
+	clock_t t0, t1;
+	const float* v;
+	int i, j, ret = 1;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-w") == 0 && i+1 < argc)
+			windingRule = parseWinding(argv[++i]);
+		else if (strcmp(argv[i], "-e") == 0 && i+1 < argc)
+			elementType = parseElementType(argv[++i]);
+		else if (strcmp(argv[i], "-p") == 0 && i+1 < argc)
+			polySize = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-cdt") == 0)
+			cdt = 1;
+		else if (strcmp(argv[i], "-a") == 0)
+			adaptive = 1;
+		else if (strcmp(argv[i], "-g") == 0)
+			grouped = 1;
+		else if (strcmp(argv[i], "-n") == 0 && i+1 < argc)
+			runs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-o") == 0 && i+1 < argc)
+			outPath = argv[++i];
+		else if (strcmp(argv[i], "-c") == 0 && i+1 < argc)
+			capturePath = argv[++i];
+		else if (strcmp(argv[i], "-t") == 0 && i+1 < argc)
+			tracePath = argv[++i];
+		else if (argv[i][0] != '-' && inPath == NULL)
+			inPath = argv[i];
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if (inPath == NULL || windingRule < 0 || elementType < 0 || polySize < 3 || runs < 1)
+	{
+		usage();
+		return 1;
+	}
+
+	if (isTrace(inPath))
+		return replayTrace(inPath, runs);
+
+	memset(&in, 0, sizeof(in));
+	if (hasSuffix(inPath, ".svg") ? !loadSvg(&in, inPath) : !loadContours(&in, inPath))
+	{
+		printf("Could not load %s\n", inPath);
+		goto out;
+	}
+	{
+		int nverts = 0;
+		for (i = 0; i < in.ncontours; ++i)
+			nverts += in.counts[i];
+		printf("%s: %d contours, %d vertices\n", inPath, in.ncontours, nverts);
+	}
+
+	initAlloc(&ma, &mem);
+	ma.adaptiveBuckets = adaptive;
+
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		best[i] = -1.0;
+		sum[i] = 0.0;
+	}
+
+	// The tracer uses the default allocator, so that it does not count in the memory use.
+	if (tracePath)
+	{
+		tracer = tessNewTracer(NULL, runs * 16);
+		if (!tracer)
+		{
+			printf("Could not create tracer\n");
+			goto out;
+		}
+	}
+
+	for (j = 0; j < runs; ++j)
+	{
+		if (tess)
+			tessDeleteTess(tess);
+		tess = tessNewTess(&ma);
+		if (!tess)
+		{
+			printf("Could not create tesselator\n");
+			goto out;
+		}
+		if (capturePath && j == 0 && !tessBeginCapture(tess, capturePath, 0))
+		{
+			printf("Could not write %s\n", capturePath);
+			goto out;
+		}
+		tessSetOption(tess, TESS_CONSTRAINED_DELAUNAY_TRIANGULATION, cdt);
+		tessSetOption(tess, TESS_GROUPED_OUTPUT, grouped);
+		tessSetOption(tess, TESS_PHASE_TIMINGS, 1);
+		tessSetTracer(tess, tracer);
+
+		t0 = clock();
+		v = in.verts;
+		for (i = 0; i < in.ncontours; ++i)
+		{
+			tessAddContour(tess, in.vertexSize, v, sizeof(float)*in.vertexSize, in.counts[i]);
+			v += in.counts[i]*in.vertexSize;
+		}
+		t1 = clock();
+		if (!tessTesselate(tess, windingRule, elementType, polySize, in.vertexSize, 0))
+		{
+			printf("Tesselation failed, error %d\n", tessGetError(tess));
+			goto out;
+		}
+
+		stats = tessGetStats(tess);
+		t[PHASE_ADD] = (double)(t1 - t0) * 1000.0 / CLOCKS_PER_SEC;
+		t[PHASE_PROJECT] = stats->projectTime * 1000.0;
+		t[PHASE_SWEEP] = stats->sweepTime * 1000.0;
+		t[PHASE_TESSELLATE] = stats->tessellateTime * 1000.0;
+		t[PHASE_OUTPUT] = stats->outputTime * 1000.0;
+		t[PHASE_TOTAL] = 0.0;
+		for (i = 0; i < PHASE_TOTAL; ++i)
+			t[PHASE_TOTAL] += t[i];
+		for (i = 0; i < PHASE_COUNT; ++i)
+		{
+			if (best[i] < 0.0 || t[i] < best[i])
+				best[i] = t[i];
+			sum[i] += t[i];
+		}
+	}
+
+	stats = tessGetStats(tess);
+	printf("%d runs, %d vertices after sweep, %d output vertices, %d elements\n",
+		   runs, stats->sweepVertexCount, tessGetVertexCount(tess), tessGetElementCount(tess));
+	if (grouped)
+		printf("%d groups, %.1f elements per group\n", tessGetGroupCount(tess),
+			   tessGetGroupCount(tess) > 0 ? (double)tessGetElementCount(tess) / tessGetGroupCount(tess) : 0.0);
+	printf("%-16s %10s %10s\n", "phase", "best ms", "mean ms");
+	for (i = 0; i < PHASE_COUNT; ++i)
+		printf("%-16s %10.3f %10.3f\n", phaseNames[i], best[i], sum[i] / runs);
+	printf("Sweep: %d events, %d regions max, search %.1f steps mean (%d max), dirty walk %.1f regions mean (%d max), %d left and %d right splices\n",
+		   stats->sweepEventCount, stats->maxActiveRegions, stats->dictSearchMeanSteps, stats->dictSearchMaxSteps,
+		   stats->dirtyWalkMeanLength, stats->dirtyWalkMaxLength, stats->leftSpliceCount, stats->rightSpliceCount);
+	printf("Regions at events:");
+	for (i = 0; i < TESS_SWEEP_HISTOGRAM_SIZE; ++i)
+	{
+		if (stats->activeRegionHistogram[i] > 0)
+			printf(" %d%s:%d", 1 << i, i == TESS_SWEEP_HISTOGRAM_SIZE-1 ? "+" : "", stats->activeRegionHistogram[i]);
+	}
+	printf("\n");
+	printf("Memory: %.1f kB peak, %.1f kB in use after the run, %d allocations per run\n",
+		   mem.peak/1024.0, mem.current/1024.0, mem.allocs / runs);
+	{
+		const TESSallocStats* as = tessGetAllocStats(tess);
+		printf("Allocator calls: %d memalloc, %d memrealloc, %d memfree\n", as->allocCount, as->reallocCount, as->freeCount);
+		printf("%-16s %8s %8s %8s %8s %8s %10s\n", "buckets", "size", "items", "live", "peak", "buckets", "kB");
+		for (i = 0; i < TESS_BUCKETS_COUNT; ++i)
+		{
+			const TESSbucketStats* bs = &as->buckets[i];
+			if (bs->name)
+				printf("%-16s %8d %8d %8d %8d %8d %10.1f\n", bs->name, bs->itemSize, bs->bucketSize,
+					   bs->liveItems, bs->peakItems, bs->bucketCount, bs->bytes/1024.0);
+		}
+	}
+
+	if (outPath)
+	{
+		const int ok = hasSuffix(outPath, ".obj")
+			? writeObj(tess, outPath, elementType, polySize, in.vertexSize)
+			: writeBinary(tess, outPath, elementType, polySize, in.vertexSize);
+		if (!ok)
+		{
+			printf("Could not write %s\n", outPath);
+			goto out;
+		}
+	}
+	if (tracer && !tessWriteTrace(tracer, tracePath))
+	{
+		printf("Could not write %s\n", tracePath);
+		goto out;
+	}
+	ret = 0;
+
+out:
+	if (tess)
+		tessDeleteTess(tess);
+	if (tracer)
+		tessDeleteTracer(tracer);
+	free(in.verts);
+	free(in.counts);
+	return ret;
+}
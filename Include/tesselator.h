@@ -122,17 +122,115 @@ enum TessElementType
 // TESS_REVERSE_CONTOURS
 //   If enabled, tessAddContour() will treat CW contours as CCW and vice versa
 //   Disabled by default.
+//
+// TESS_AUTO_SWEEP_DIRECTION
+//   If enabled, the sweep direction is chosen from the two axes of the projection plane,
+//   so that fewer edges are expected to cross the sweep line. Helps with tall and narrow
+//   input, the chosen direction is reported in TESSstats::sweepAxis.
+//   Disabled by default.
+//
+// TESS_GROUPED_OUTPUT
+//   If enabled, the polygons are output grouped by the monotone region of the sweep they
+//   come from. The groups are ordered along a Morton curve by the centres of their regions,
+//   and the polygons of each group by their own centres, so that nearby polygons are
+//   output close together. tessGetGroups() returns the range and bounding box of each
+//   group. Applies to TESS_POLYGONS and TESS_CONNECTED_POLYGONS.
+//   Disabled by default.
+//
+// TESS_PHASE_TIMINGS
+//   If enabled, tessTesselate() measures the time of its phases into TESSstats.
+//   Otherwise the times are zero, unless a tracer is set (see tessSetTracer()).
+//   Disabled by default.
 
 enum TessOption
 {
 	TESS_CONSTRAINED_DELAUNAY_TRIANGULATION,
-	TESS_REVERSE_CONTOURS
+	TESS_REVERSE_CONTOURS,
+	TESS_AUTO_SWEEP_DIRECTION,
+	TESS_GROUPED_OUTPUT,
+	TESS_PHASE_TIMINGS,
+};
+
+// Error codes returned by tessGetError().
+// TESS_ERROR_NONE
+//   No error.
+// TESS_ERROR_OUT_OF_MEMORY
+//   An allocation failed.
+// TESS_ERROR_BUDGET_EXCEEDED
+//   The sweep created more intersection vertices than TESSalloc::extraVertices allows
+//   when the allocator does not provide memrealloc.
+// TESS_ERROR_INVALID_INPUT
+//   A contour vertex is not finite, or tessTesselate() was called with invalid parameters.
+
+enum TessError
+{
+	TESS_ERROR_NONE,
+	TESS_ERROR_OUT_OF_MEMORY,
+	TESS_ERROR_BUDGET_EXCEEDED,
+	TESS_ERROR_INVALID_INPUT,
+};
+
+// Join types used by tessAddOffsetContour() at the convex corners of the offset contour.
+// TESS_JOIN_ROUND
+//   Corners are rounded with an arc, see 'arcTolerance'.
+// TESS_JOIN_MITER
+//   Corners are extended to a sharp point, unless the point is further than 'miterLimit'
+//   times the offset from the vertex, in which case the corner is squared.
+// TESS_JOIN_SQUARE
+//   Corners are cut flat at the offset distance from the vertex.
+
+enum TessJoinType
+{
+	TESS_JOIN_ROUND,
+	TESS_JOIN_MITER,
+	TESS_JOIN_SQUARE,
+};
+
+// Path commands used by tessAddPath(). Each command consumes its coordinates
+// from the coordinate array in order.
+// TESS_PATH_MOVETO (x,y)
+//   Ends the current sub-path and starts a new one at (x,y).
+// TESS_PATH_LINETO (x,y)
+//   Straight line from the current point to (x,y).
+// TESS_PATH_QUADTO (cx,cy, x,y)
+//   Quadratic Bezier from the current point to (x,y) with control point (cx,cy).
+// TESS_PATH_CUBICTO (c1x,c1y, c2x,c2y, x,y)
+//   Cubic Bezier from the current point to (x,y) with control points (c1x,c1y) and (c2x,c2y).
+// TESS_PATH_ARCTO (cx,cy, angle)
+//   Circular arc around (cx,cy) starting from the current point, sweeping 'angle' radians,
+//   counter-clockwise for positive angle.
+// TESS_PATH_CLOSE
+//   Ends the current sub-path, the current point moves back to its start.
+// Sub-paths are always closed, the last point is connected to the first one.
+
+enum TessPathCommand
+{
+	TESS_PATH_MOVETO,
+	TESS_PATH_LINETO,
+	TESS_PATH_QUADTO,
+	TESS_PATH_CUBICTO,
+	TESS_PATH_ARCTO,
+	TESS_PATH_CLOSE,
 };
 
 typedef float TESSreal;
 typedef int TESSindex;
 typedef struct TESStesselator TESStesselator;
 typedef struct TESSalloc TESSalloc;
+typedef struct TESSstats TESSstats;
+typedef struct TESSlod TESSlod;
+typedef struct TESSscheduler TESSscheduler;
+typedef struct TESStileset TESStileset;
+typedef struct TESSpool TESSpool;
+typedef struct TESStracer TESStracer;
+typedef struct TESSjob TESSjob;
+typedef struct TESSschedulerStats TESSschedulerStats;
+typedef struct TESSbucketStats TESSbucketStats;
+typedef struct TESSallocStats TESSallocStats;
+typedef struct TESSgroup TESSgroup;
+
+// Completion callback of tessSubmitJob().
+typedef void TESSjobCallback( TESSjob* job, int result, void* userData );
 
 #define TESS_UNDEF (~(TESSindex)0)
 
@@ -154,6 +252,11 @@ typedef struct TESSalloc TESSalloc;
 // has found intersecting segments and needs to add new vertex. This defency can be cured by
 // allocating some extra vertices beforehand. The 'extraVertices' variable allows to specify
 // number of expected extra vertices.
+//
+// Setting 'adaptiveBuckets' replaces the fixed bucket sizes: each allocator starts with a
+// small bucket, or one sized from the number of vertices when it is known as the first contour
+// is added (see tessAddContour() and tessAddContours()), and doubles the size of each new bucket
+// up to 65536 items. Large inputs then need only a few allocations and small ones stay small.
 struct TESSalloc
 {
 	void *(*memalloc)( void *userData, unsigned int size );
@@ -166,8 +269,96 @@ struct TESSalloc
 	int dictNodeBucketSize;		// 512
 	int regionBucketSize;		// 256
 	int extraVertices;			// Number of extra vertices allocated for the priority queue.
+	int adaptiveBuckets;		// If non-zero, the bucket sizes above are ignored and the buckets grow.
 };
 
+// Number of buckets in TESSstats::activeRegionHistogram.
+#define TESS_SWEEP_HISTOGRAM_SIZE 16
+
+// Statistics of the last tessTesselate() call, see tessGetStats().
+struct TESSstats
+{
+	int sweepAxis;			// Coordinate axis (0=x, 1=y, 2=z) the sweep line moved along.
+	int inputVertexCount;	// Number of vertices before the sweep.
+	int sweepVertexCount;	// Number of vertices after the sweep, including the intersections.
+	// The times are only measured with TESS_PHASE_TIMINGS or a tracer.
+	double projectTime;		// Seconds spent projecting the vertices onto the sweep plane.
+	double sweepTime;		// Seconds spent in the sweep.
+	double tessellateTime;	// Seconds spent tesselating the regions (or extracting the boundary).
+	double outputTime;		// Seconds spent writing the output.
+
+	// Sweep line statistics.
+	int sweepEventCount;	// Number of sweep events, coincident vertices are one event.
+	int maxActiveRegions;	// Largest number of regions crossed by the sweep line at an event.
+	// Events by the number n of regions crossed by the sweep line: bucket i counts
+	// 2^i <= n < 2^(i+1), bucket 0 also n == 0, the last bucket also all larger n.
+	int activeRegionHistogram[TESS_SWEEP_HISTOGRAM_SIZE];
+	int dictSearchCount;		// Number of edge dictionary searches (one per left vertex).
+	int dictSearchMaxSteps;		// Most comparisons made by one search.
+	double dictSearchMeanSteps;	// Mean number of comparisons per search.
+	int dirtyWalkCount;			// Number of walks over the regions whose edges changed.
+	int dirtyWalkMaxLength;		// Most regions checked by one walk.
+	double dirtyWalkMeanLength;	// Mean number of regions checked per walk.
+	int leftSpliceCount;	// Number of edge order repairs at the right end of edges.
+	int rightSpliceCount;	// Number of edge order repairs at the left end of edges.
+};
+
+// A group of output elements, see TESS_GROUPED_OUTPUT.
+struct TESSgroup
+{
+	int firstElement;	// Index of the first element of the group.
+	int elementCount;	// Number of elements in the group.
+	TESSreal bmin[3];	// Bounding box of the vertices of the elements.
+	TESSreal bmax[3];
+};
+
+// Bucket allocators of a tesselator, see TESSallocStats.
+enum TessBucketAllocator
+{
+	TESS_BUCKETS_MESH_EDGES,		// TESSalloc::meshEdgeBucketSize
+	TESS_BUCKETS_MESH_VERTICES,		// TESSalloc::meshVertexBucketSize
+	TESS_BUCKETS_MESH_FACES,		// TESSalloc::meshFaceBucketSize
+	TESS_BUCKETS_DICT_NODES,		// TESSalloc::dictNodeBucketSize
+	TESS_BUCKETS_REGIONS,			// TESSalloc::regionBucketSize
+	TESS_BUCKETS_CDT_NODES,			// Edge stack of the constrained Delaunay refinement.
+	TESS_BUCKETS_COUNT,
+};
+
+// Usage of one bucket allocator during the last tessTesselate() call.
+struct TESSbucketStats
+{
+	const char* name;	// Name of the allocator, NULL if it was not used.
+	int itemSize;		// Size of an item in bytes.
+	int bucketSize;		// Number of items in the most recent bucket.
+	int liveItems;		// Number of items in use at the end of the call.
+	int peakItems;		// Largest number of items in use at once.
+	int bucketCount;	// Number of buckets allocated.
+	int bytes;			// Bytes allocated for the buckets.
+};
+
+// Allocator statistics returned by tessGetAllocStats(). They cover the last tessTesselate()
+// call, including adding its contours.
+struct TESSallocStats
+{
+	TESSbucketStats buckets[TESS_BUCKETS_COUNT];	// Indexed by TessBucketAllocator.
+	int allocCount;		// Number of TESSalloc::memalloc calls.
+	int reallocCount;	// Number of TESSalloc::memrealloc calls.
+	int freeCount;		// Number of TESSalloc::memfree calls.
+};
+
+// Scheduler statistics returned by tessGetSchedulerStats().
+// The latencies are measured from tessSubmitJob() to the completion of the job, and are
+// rounded up to the next step of a histogram growing by sqrt(2).
+struct TESSschedulerStats
+{
+	int threadCount;		// Number of worker threads.
+	int queueDepth;			// Number of tasks waiting to be run.
+	int jobsInFlight;		// Number of submitted jobs which have not completed yet.
+	int jobsCompleted;		// Number of jobs completed since the scheduler was created.
+	double latency50;		// Median job latency in seconds.
+	double latency90;		// 90th percentile job latency in seconds.
+	double latency99;		// 99th percentile job latency in seconds.
+};
 
 //
 // Example use:
@@ -199,6 +390,108 @@ void tessDeleteTess( TESStesselator *tess );
 //   count - number of vertices in contour.
 void tessAddContour( TESStesselator *tess, int size, const void* pointer, int stride, int count );
 
+// tessAddContours() - Adds several contours stored one after another in the vertex array.
+// Gives the same result as calling tessAddContour() for each contour. If a scheduler is set
+// (see tessSetScheduler()), large inputs are added in parallel.
+// Parameters:
+//   tess - pointer to tesselator object.
+//   size - number of coordinates per vertex. Must be 2 or 3.
+//   pointer - pointer to the first coordinate of the first vertex in the array.
+//   stride - defines offset in bytes between consecutive vertices.
+//   counts - number of vertices in each contour.
+//   contourCount - number of contours.
+void tessAddContours( TESStesselator *tess, int size, const void* pointer, int stride,
+					  const int* counts, int contourCount );
+
+// tessSetScheduler() - Sets the scheduler used to run parts of the work of the tesselator
+// in parallel, or NULL to do all the work on the calling thread (default). Currently these are
+// tessAddContours(), and the triangulation of the regions and writing of the output in
+// tessTesselate(). The results are the same as without a scheduler. The scheduler must not be deleted while it is set.
+// Parameters:
+//   tess - pointer to tesselator object.
+//   sched - pointer to scheduler, or NULL.
+void tessSetScheduler( TESStesselator *tess, TESSscheduler* sched );
+
+// tessAddOffsetContour() - Adds a contour offset (inflated or deflated) by given distance.
+// The offset contour is generated directly into the tesselator, the self-intersections
+// it may contain are resolved by the sweep in tessTesselate(). Use TESS_WINDING_POSITIVE
+// and normal (0,0,1) to get the buffered shape, for example with TESS_BOUNDARY_CONTOURS
+// to get the outline or TESS_POLYGONS to triangulate it in the same pass.
+// The offset is calculated in the XY-plane. Positive offset inflates CCW contours and
+// deflates CW contours (holes), negative offset does the opposite.
+// The generated vertices map to the source vertex they were offset from in tessGetVertexIndices().
+// Parameters:
+//   tess - pointer to tesselator object.
+//   size - number of coordinates per vertex. Must be 2 or 3.
+//   pointer - pointer to the first coordinate of the first vertex in the array.
+//   stride - defines offset in bytes between consecutive vertices.
+//   count - number of vertices in contour.
+//   offset - offset distance.
+//   joinType - how convex corners are joined, must be one of TessJoinType.
+//   miterLimit - maximum miter length relative to the offset for TESS_JOIN_MITER, 2 if zero.
+//   arcTolerance - maximum distance between an arc and its approximation for TESS_JOIN_ROUND,
+//                  1% of the offset if zero.
+void tessAddOffsetContour( TESStesselator *tess, int size, const void* pointer, int stride, int count,
+						   TESSreal offset, int joinType, TESSreal miterLimit, TESSreal arcTolerance );
+
+// tessAddPath() - Adds contours described by path commands, flattening the curves directly
+// into the tesselator. Curves are split adaptively so that the flattened contour stays within
+// 'tolerance' of the true curve, flat curves use fewer vertices than strongly bent ones.
+// For screen space output, a tolerance of about quarter of a pixel (in path units) works well.
+// The generated vertices map to the index of the command which produced them in
+// tessGetVertexIndices(), offset by the vertex index counter as in tessAddContour().
+// Parameters:
+//   tess - pointer to tesselator object.
+//   commands - pointer to array of path commands, see TessPathCommand.
+//   commandCount - number of commands.
+//   coords - pointer to the array of 2D coordinates used by the commands.
+//   tolerance - maximum distance between a curve and its approximation, 0.25 if zero.
+void tessAddPath( TESStesselator *tess, const unsigned char* commands, int commandCount,
+				  const TESSreal* coords, TESSreal tolerance );
+
+// tessNewLod() - Creates level of detail chain for a path, see tessAddPath() for the path format.
+// The path is copied and everything which does not depend on the tolerance is precalculated,
+// so that each level can be added cheaply on demand using tessAddLodPath().
+// The tolerance of level N is 'tolerance * ratio^N'. Coarser levels produce fewer vertices,
+// and sub-paths which are smaller than the tolerance of a level are left out of it.
+// Parameters:
+//   alloc - pointer to a filled TESSalloc struct or NULL to use default malloc based allocator.
+//   commands - pointer to array of path commands, see TessPathCommand.
+//   commandCount - number of commands.
+//   coords - pointer to the array of 2D coordinates used by the commands.
+//   tolerance - tolerance of the finest level (0), 0.25 if zero.
+//   ratio - tolerance ratio between consecutive levels, 2 if less or equal to one.
+// Returns new LOD chain, or NULL if out of memory.
+TESSlod* tessNewLod( TESSalloc* alloc, const unsigned char* commands, int commandCount,
+					 const TESSreal* coords, TESSreal tolerance, TESSreal ratio );
+
+// tessDeleteLod() - Deletes LOD chain.
+// Parameters:
+//   lod - pointer to LOD chain to be deleted.
+void tessDeleteLod( TESSlod* lod );
+
+// tessGetLodTolerance() - Returns the flattening tolerance of specified level.
+TESSreal tessGetLodTolerance( const TESSlod* lod, int level );
+
+// tessAddLodPath() - Adds the path of a LOD chain flattened at specified level.
+// The generated vertices map to path commands in tessGetVertexIndices() as in tessAddPath().
+// Parameters:
+//   tess - pointer to tesselator object.
+//   lod - pointer to LOD chain.
+//   level - level of detail, 0 is the finest.
+void tessAddLodPath( TESStesselator *tess, const TESSlod* lod, int level );
+
+// tessSetClipRect() - Sets rectangle which the contours added after this call are clipped to.
+// Contours completely outside the rectangle are rejected, contours crossing it are trimmed so
+// that their parts outside the rectangle follow its boundary instead. The sweep and the output
+// then only process the geometry inside the rectangle, and the output has the same winding
+// inside the rectangle as the unclipped input. Clipping is done in the XY-plane and applies to
+// tessAddContour(). Vertices created on the rectangle boundary get index TESS_UNDEF.
+// Parameters:
+//   tess - pointer to tesselator object.
+//   minx, miny, maxx, maxy - the clip rectangle, clipping is disabled if the rectangle is empty.
+void tessSetClipRect( TESStesselator *tess, TESSreal minx, TESSreal miny, TESSreal maxx, TESSreal maxy );
+
 // tessSetOption() - Toggles optional tessellation parameters
 // Parameters:
 //  option - one of TessOption
@@ -214,9 +507,67 @@ void tessSetOption( TESStesselator *tess, int option, int value );
 //   vertexSize - defines the number of coordinates in tesselation result vertex, must be 2 or 3.
 //   normal - defines the normal of the input contours, of null the normal is calculated automatically.
 // Returns:
-//   1 if succeed, 0 if failed.
+//   1 if succeed, 0 if failed or there were no contours. Use tessGetError() to find out why it failed.
+// The contours added so far are consumed whether the call succeeds or not.
 int tessTesselate( TESStesselator *tess, int windingRule, int elementType, int polySize, int vertexSize, const TESSreal* normal );
 
+// tessBeginCapture() - Starts recording the calls made to the tesselator into a trace file,
+// which can be replayed later with the same result (see the tesstool example). The contours,
+// options, clip rectangle and the parameters, result and duration of each tessTesselate() call
+// are recorded. Input added with tessAddLodPath() is marked in the trace, but not recorded.
+// A capture which was already running is ended first. The capture ends when the size limit
+// would be exceeded, and the trace is marked truncated.
+// Parameters:
+//   tess - pointer to tesselator object.
+//   path - name of the trace file to write.
+//   maxSize - maximum size of the trace in bytes, or 0 for no limit.
+// Returns 1 if the capture started, 0 if the file could not be created or out of memory.
+int tessBeginCapture( TESStesselator *tess, const char* path, int maxSize );
+
+// tessEndCapture() - Ends the capture and closes the trace file. Deleting the tesselator
+// or releasing it to a pool ends the capture too.
+void tessEndCapture( TESStesselator *tess );
+
+// tessNewTracer() - Creates a tracer which collects the timeline of tessTesselate() calls.
+// Each call records begin and end of its phases: projection, degenerate removal, priority
+// queue init, sweep, triangulation, CDT and output, nested in the whole call. A tracer can be
+// shared by tesselators running on different threads, events which do not fit are dropped.
+// Parameters:
+//   alloc - pointer to a filled TESSalloc struct, or NULL to use the default allocator.
+//   maxEvents - maximum number of events kept.
+// Returns new tracer, or NULL if out of memory.
+TESStracer* tessNewTracer( TESSalloc* alloc, int maxEvents );
+
+// tessDeleteTracer() - Deletes a tracer. It must not be set to any tesselator.
+void tessDeleteTracer( TESStracer* tracer );
+
+// tessSetTracer() - Sets the tracer which records the tessTesselate() calls of the tesselator.
+// With no tracer set (the default) the tracing costs a test per phase.
+// Parameters:
+//   tess - pointer to tesselator object.
+//   tracer - pointer to tracer, or NULL to stop tracing.
+void tessSetTracer( TESStesselator *tess, TESStracer* tracer );
+
+// tessWriteTrace() - Writes the events collected so far as Chrome trace event JSON, which
+// can be opened in chrome://tracing or Perfetto. Must not be called while tesselating.
+// Parameters:
+//   tracer - pointer to tracer.
+//   path - name of the JSON file to write.
+// Returns 1 if succeed, 0 if the file could not be written.
+int tessWriteTrace( TESStracer* tracer, const char* path );
+
+// tessGetError() - Returns the reason the last tessTesselate() call failed, one of TessError.
+// Errors raised while adding contours are reported by the tessTesselate() call which consumes them.
+// The error is cleared when the first contour after tessTesselate() is added.
+int tessGetError( TESStesselator *tess );
+
+// tessGetStats() - Returns statistics of the last tessTesselate() call.
+const TESSstats* tessGetStats( TESStesselator *tess );
+
+// tessGetAllocStats() - Returns the allocator statistics of the last tessTesselate() call,
+// which tell how well the bucket sizes of TESSalloc fit the input.
+const TESSallocStats* tessGetAllocStats( TESStesselator *tess );
+
 // tessGetVertexCount() - Returns number of vertices in the tesselated output.
 int tessGetVertexCount( TESStesselator *tess );
 
@@ -235,6 +586,150 @@ int tessGetElementCount( TESStesselator *tess );
 // tessGetElements() - Returns pointer to the first element.
 const TESSindex* tessGetElements( TESStesselator *tess );
 
+// tessGetGroupCount() - Returns number of element groups, see TESS_GROUPED_OUTPUT.
+int tessGetGroupCount( TESStesselator *tess );
+
+// tessGetGroups() - Returns pointer to the first group, or NULL if the output is not grouped.
+const TESSgroup* tessGetGroups( TESStesselator *tess );
+
+// tessNewScheduler() - Creates a pool of worker threads used by the parallel functions.
+// The calling thread helps the workers while it waits for the results, so the number of
+// threads working is threadCount+1. If the scheduler is used, the allocator must be thread safe.
+// Parameters:
+//   alloc - pointer to a filled TESSalloc struct or NULL to use default malloc based allocator.
+//   threadCount - number of worker threads, negative value uses one less than the number of processors.
+// Returns new scheduler, or NULL if failed.
+TESSscheduler* tessNewScheduler( TESSalloc* alloc, int threadCount );
+
+// tessDeleteScheduler() - Stops the worker threads and deletes the scheduler.
+// Parameters:
+//   sched - pointer to scheduler to be deleted.
+void tessDeleteScheduler( TESSscheduler* sched );
+
+// tessNewPool() - Creates a thread safe pool of reusable tesselators.
+// Tesselators are created on first use and keep their internal buckets between uses,
+// acquiring and releasing them does not lock. If the pool is used from several threads,
+// the allocator must be thread safe.
+// Parameters:
+//   alloc - pointer to a filled TESSalloc struct or NULL to use default malloc based allocator.
+//   capacity - maximum number of pooled tesselators, at most 65535.
+// Returns new pool, or NULL if failed.
+TESSpool* tessNewPool( TESSalloc* alloc, int capacity );
+
+// tessDeletePool() - Deletes the pool and its tesselators.
+// All the acquired tesselators must have been released.
+// Parameters:
+//   pool - pointer to pool to be deleted.
+void tessDeletePool( TESSpool* pool );
+
+// tessPoolAcquire() - Takes a tesselator from the pool.
+// The tesselator is in the same state as a new one. If all pooled tesselators are in use,
+// a new tesselator is created, which is deleted again when it is released.
+// Returns tesselator, or NULL if out of memory.
+TESStesselator* tessPoolAcquire( TESSpool* pool );
+
+// tessPoolRelease() - Resets a tesselator and returns it to the pool it was acquired from.
+// The output and the pending contours of the tesselator are discarded.
+// Parameters:
+//   pool - pointer to pool.
+//   tess - pointer to tesselator returned by tessPoolAcquire().
+void tessPoolRelease( TESSpool* pool, TESStesselator* tess );
+
+// tessTesselateBatch() - Tesselates the contours added to each tesselator of a batch.
+// Each tesselator is run as a separate job on the scheduler, the largest first. Large inputs
+// which consist of separate parts are split further, so that a single big input does not
+// keep the other threads waiting. Without a scheduler the tesselators are run one by one.
+// The output of a split input is the same as from tessTesselate(), but the elements may be
+// in a different order.
+// Parameters:
+//   sched - pointer to scheduler, or NULL.
+//   tess - array of tesselators, NULL entries are skipped.
+//   count - number of tesselators.
+//   windingRule, elementType, polySize, vertexSize, normal - see tessTesselate().
+// Returns:
+//   1 if all tesselators succeed, 0 if any failed (see tessGetError()).
+int tessTesselateBatch( TESSscheduler* sched, TESStesselator** tess, int count,
+						int windingRule, int elementType, int polySize, int vertexSize,
+						const TESSreal* normal );
+
+// tessGetSchedulerStats() - Returns the queue and job statistics of a scheduler.
+// Parameters:
+//   sched - pointer to scheduler.
+//   stats - pointer to struct to fill in.
+void tessGetSchedulerStats( TESSscheduler* sched, TESSschedulerStats* stats );
+
+// tessSubmitJob() - Tesselates the contours of a tesselator asynchronously.
+// The tesselator is owned by the job until it has completed, after which the results
+// are read from the tesselator as usual (see tessGetVertices() etc.). Large inputs are
+// split like in tessTesselateBatch(). Without a scheduler (or with one without workers)
+// the job is run before the function returns.
+// Parameters:
+//   sched - pointer to scheduler, or NULL.
+//   tess - pointer to tesselator with the contours added.
+//   windingRule, elementType, polySize, vertexSize, normal - see tessTesselate().
+//   callback - called with the result when the job completes, on the thread which ran it,
+//              or NULL. The callback may read the results, but must not delete the job.
+//   userData - passed to the callback.
+// Returns new job, or NULL if out of memory.
+TESSjob* tessSubmitJob( TESSscheduler* sched, TESStesselator* tess,
+						int windingRule, int elementType, int polySize, int vertexSize,
+						const TESSreal* normal, TESSjobCallback* callback, void* userData );
+
+// tessIsJobDone() - Returns 1 if the job has completed (including its callback), 0 if not.
+int tessIsJobDone( TESSjob* job );
+
+// tessWaitJob() - Waits for the job to complete. The calling thread runs queued tasks while it waits.
+// Returns:
+//   1 if the tesselation succeeded, 0 if it failed (see tessGetError()).
+int tessWaitJob( TESSjob* job );
+
+// tessDeleteJob() - Waits for the job to complete and deletes it. The tesselator is not deleted.
+void tessDeleteJob( TESSjob* job );
+
+// tessNewTileset() - Creates a grid of tiles for tessTesselateTiles().
+// Tile (column,row) covers the rectangle starting at (originX + column*tileWidth, originY + row*tileHeight).
+// Parameters:
+//   alloc - pointer to a filled TESSalloc struct or NULL to use default malloc based allocator.
+//   originX, originY - bottom left corner of the grid.
+//   tileWidth, tileHeight - size of a tile.
+//   columns, rows - number of tiles.
+// Returns new tileset, or NULL if failed.
+TESStileset* tessNewTileset( TESSalloc* alloc, TESSreal originX, TESSreal originY,
+							 TESSreal tileWidth, TESSreal tileHeight, int columns, int rows );
+
+// tessDeleteTileset() - Deletes tileset and the results of its tiles.
+// Parameters:
+//   ts - pointer to tileset to be deleted.
+void tessDeleteTileset( TESStileset* ts );
+
+// tessTesselateTiles() - Tesselates a layer of contours cut into the tiles of a tileset.
+// The contours are binned to the tiles they overlap in a single pass, and each tile is
+// tesselated as a separate job clipping its contours to the tile (see tessSetClipRect()).
+// The jobs are run in parallel on the scheduler, or one by one on the calling thread if
+// 'sched' is NULL. The vertex indices of the results refer to the vertices of the layer.
+// Parameters:
+//   ts - pointer to tileset.
+//   sched - pointer to scheduler, or NULL.
+//   size - number of coordinates per vertex. Must be 2 or 3.
+//   vertices - pointer to the first coordinate of the first vertex of the layer.
+//   stride - defines offset in bytes between consecutive vertices.
+//   contours - pointer to pairs of (first vertex, vertex count), one for each contour.
+//   contourCount - number of contours.
+//   windingRule, elementType, polySize, vertexSize, normal - see tessTesselate().
+// Returns:
+//   1 if all tiles succeed, 0 if any failed.
+int tessTesselateTiles( TESStileset* ts, TESSscheduler* sched,
+						int size, const void* vertices, int stride,
+						const int* contours, int contourCount,
+						int windingRule, int elementType, int polySize, int vertexSize,
+						const TESSreal* normal );
+
+// tessGetTile() - Returns the result of a tile from the last tessTesselateTiles() call.
+// Use tessGetVertices(), tessGetElements() etc. to access the output of the tile,
+// the returned tesselator is owned by the tileset and must not be modified.
+// Returns NULL if the tile is empty or failed.
+TESStesselator* tessGetTile( const TESStileset* ts, int column, int row );
+
 #ifdef __cplusplus
 };
 #endif
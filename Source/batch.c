@@ -0,0 +1,539 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tess.h"
+#include "scheduler.h"
+#include "capture.h"
+#include "trace.h"
+
+/* Batch tessellation.  Each tesselator of the batch is a task of its own,
+* spawned largest first so that the big inputs start early and the small
+* ones fill in the gaps.
+*
+* A large input which consists of separate parts is split further.  The
+* contours are cut recursively at the gaps between their bounds, first
+* along the sweep direction (slabs) and then across it, until the pieces
+* cannot be cut.  Contours in different pieces can not intersect or
+* contain each other, so the pieces are independent under every winding
+* rule.  The pieces are packed into parts of similar size, and each part is
+* tessellated by a separate tesselator using the projection of the whole
+* input (see tessProjectPolygon()), so the output is the same as when the
+* input is tessellated at once, apart from the order of the elements.
+*/
+
+/* Inputs with fewer vertices are tessellated as a whole. */
+#define TESS_BATCH_SPLIT_MIN	8192
+/* Parts are packed to at least this many vertices. */
+#define TESS_BATCH_PART_MIN		2048
+/* Limits the recursion of the partitioning. */
+#define TESS_BATCH_MAX_DEPTH	32
+
+typedef struct TessBatchParams {
+	int windingRule;
+	int elementType;
+	int polySize;
+	int vertexSize;
+	const TESSreal *normal;
+} TessBatchParams;
+
+typedef struct TessBatchItem {
+	TESSscheduler *sched;
+	TESStesselator *tess;
+	const TessBatchParams *params;
+	int size;		/* number of input vertices */
+	int result;
+	TessTask task;
+} TessBatchItem;
+
+typedef struct TessContourRef {
+	TESShalfEdge *e;		/* an edge of the contour loop */
+	TESSreal bmin[2];
+	TESSreal bmax[2];
+	int count;				/* number of vertices */
+} TessContourRef;
+
+typedef struct TessBatchPart {
+	TessBatchItem *item;
+	const TessContourRef *contours;
+	int contourCount;
+	TESStesselator *tess;
+	int result;
+	TessTask task;
+} TessBatchPart;
+
+static int CountVertices( TESSmesh *mesh )
+{
+	TESSvertex *v, *vHead;
+	int n = 0;
+	if( mesh == NULL )
+		return 0;
+	vHead = &mesh->vHead;
+	for( v = vHead->next; v != vHead; v = v->next )
+		n++;
+	return n;
+}
+
+static int CompareItemSize( const void *a, const void *b )
+{
+	const TessBatchItem *ia = (const TessBatchItem*)a;
+	const TessBatchItem *ib = (const TessBatchItem*)b;
+	return ib->size - ia->size;
+}
+
+static int CompareMinS( const void *a, const void *b )
+{
+	TESSreal sa = ((const TessContourRef*)a)->bmin[0];
+	TESSreal sb = ((const TessContourRef*)b)->bmin[0];
+	return sa < sb ? -1 : (sa > sb ? 1 : 0);
+}
+
+static int CompareMinT( const void *a, const void *b )
+{
+	TESSreal ta = ((const TessContourRef*)a)->bmin[1];
+	TESSreal tb = ((const TessContourRef*)b)->bmin[1];
+	return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/* Collects the contour loops of the projected mesh with their bounds.
+* Returns the number of contours, or -1 if out of memory. */
+static int CollectContours( TESStesselator *tess, TessContourRef **refs )
+{
+	TESSvertex *v, *vHead = &tess->mesh->vHead;
+	TESShalfEdge *e;
+	TessContourRef *ref;
+	int n = 0;
+
+	/* v->n marks the vertices of the contours found so far. */
+	for( v = vHead->next; v != vHead; v = v->next )
+		v->n = 0;
+	for( v = vHead->next; v != vHead; v = v->next ) {
+		if( v->n ) continue;
+		e = v->anEdge;
+		do {
+			e->Org->n = 1;
+			e = e->Lnext;
+		} while( e != v->anEdge );
+		n++;
+	}
+
+	*refs = (TessContourRef*)tess->alloc.memalloc( tess->alloc.userData, sizeof(TessContourRef) * (n > 0 ? n : 1) );
+	if( *refs == NULL )
+		return -1;
+
+	ref = *refs;
+	for( v = vHead->next; v != vHead; v = v->next )
+		v->n = 0;
+	for( v = vHead->next; v != vHead; v = v->next ) {
+		if( v->n ) continue;
+		ref->e = v->anEdge;
+		ref->bmin[0] = ref->bmax[0] = v->s;
+		ref->bmin[1] = ref->bmax[1] = v->t;
+		ref->count = 0;
+		e = v->anEdge;
+		do {
+			TESSvertex *org = e->Org;
+			org->n = 1;
+			if( org->s < ref->bmin[0] ) ref->bmin[0] = org->s;
+			if( org->s > ref->bmax[0] ) ref->bmax[0] = org->s;
+			if( org->t < ref->bmin[1] ) ref->bmin[1] = org->t;
+			if( org->t > ref->bmax[1] ) ref->bmax[1] = org->t;
+			ref->count++;
+			e = e->Lnext;
+		} while( e != v->anEdge );
+		ref++;
+	}
+
+	return n;
+}
+
+/* Reorders the contours so that each independent piece is a contiguous
+* range, and sets first[i] for the contours which begin a piece.  The
+* contours are cut at the gaps along 'axis', and the resulting pieces along
+* the other axis.  'cutOther' is zero if the other axis has been tried
+* already without finding a gap. */
+static void PartitionContours( TessContourRef *refs, int n, unsigned char *first,
+							   int axis, int cutOther, int depth )
+{
+	TESSreal end;
+	int i, start;
+
+	if( n < 2 || depth >= TESS_BATCH_MAX_DEPTH )
+		return;
+
+	qsort( refs, n, sizeof(TessContourRef), axis == 0 ? CompareMinS : CompareMinT );
+
+	start = 0;
+	end = refs[0].bmax[axis];
+	for( i = 1; i <= n; ++i ) {
+		/* Touching bounds are not a gap. */
+		if( i < n && refs[i].bmin[axis] <= end ) {
+			if( refs[i].bmax[axis] > end )
+				end = refs[i].bmax[axis];
+			continue;
+		}
+		if( start == 0 && i == n ) {
+			/* No gap along this axis. */
+			if( cutOther )
+				PartitionContours( refs, n, first, !axis, 0, depth+1 );
+			return;
+		}
+		first[start] = 1;
+		PartitionContours( refs + start, i - start, first + start, !axis, 1, depth+1 );
+		if( i < n ) {
+			start = i;
+			end = refs[i].bmax[axis];
+		}
+	}
+}
+
+static void TesselatePart( void *data )
+{
+	TessBatchPart *part = (TessBatchPart*)data;
+	TESStesselator *src = part->item->tess;
+	const TessBatchParams *params = part->item->params;
+	TESStesselator *tess;
+	TESShalfEdge *e, *eSrc, *eStart;
+	int i, n;
+
+	part->result = 0;
+	part->tess = tess = tessNewTess( &src->alloc );
+	if( tess == NULL )
+		return;
+
+	tess->fixedProjection = 1;
+	for( i = 0; i < 3; ++i ) {
+		tess->sUnit[i] = src->sUnit[i];
+		tess->tUnit[i] = src->tUnit[i];
+	}
+	tess->processCDT = src->processCDT;
+	tess->tracer = src->tracer;
+
+	for( i = 0, n = 0; i < part->contourCount; ++i )
+		n += part->contours[i].count;
+	if( !tessBeginContour( tess, n ) )
+		return;
+
+	/* Copy the contours, the new edges follow each other in the same
+	* order as the edges of the source loop, with the same windings. */
+	for( i = 0; i < part->contourCount; ++i ) {
+		eStart = part->contours[i].e;
+		eSrc = eStart;
+		e = NULL;
+		do {
+			e = tessAddContourVertex( tess, e, eSrc->Org->coords[0], eSrc->Org->coords[1],
+									  eSrc->Org->coords[2], eSrc->Org->idx );
+			if( e == NULL )
+				return;
+			e->winding = eSrc->winding;
+			e->Sym->winding = eSrc->Sym->winding;
+			eSrc = eSrc->Lnext;
+		} while( eSrc != eStart );
+	}
+
+	part->result = tessTesselate( tess, params->windingRule, params->elementType,
+								  params->polySize, params->vertexSize, NULL );
+}
+
+/* Concatenates the output of the parts into the output of the item. */
+static int MergeParts( TessBatchItem *item, TessBatchPart *parts, int partCount )
+{
+	TESStesselator *tess = item->tess;
+	const TessBatchParams *params = item->params;
+	TESSalloc *alloc = &tess->alloc;
+	int vertexSize = params->vertexSize < 2 ? 2 : (params->vertexSize > 3 ? 3 : params->vertexSize);
+	int polySize = params->polySize;
+	int elementSize, vertexCount = 0, elementCount = 0;
+	int i, j, k, vbase, ebase;
+
+	for( i = 0; i < partCount; ++i ) {
+		if( !parts[i].result ) {
+			tess->error = parts[i].tess != NULL ? parts[i].tess->error : TESS_ERROR_OUT_OF_MEMORY;
+			if( tess->error == TESS_ERROR_NONE )
+				tess->error = TESS_ERROR_OUT_OF_MEMORY;
+			return 0;
+		}
+		vertexCount += parts[i].tess->vertexCount;
+		elementCount += parts[i].tess->elementCount;
+	}
+
+	if( params->elementType == TESS_BOUNDARY_CONTOURS )
+		elementSize = 2;
+	else if( params->elementType == TESS_CONNECTED_POLYGONS )
+		elementSize = polySize * 2;
+	else
+		elementSize = polySize;
+
+	tess->vertices = (TESSreal*)alloc->memalloc( alloc->userData,
+		sizeof(TESSreal) * vertexSize * (vertexCount > 0 ? vertexCount : 1) );
+	tess->vertexIndices = (TESSindex*)alloc->memalloc( alloc->userData,
+		sizeof(TESSindex) * (vertexCount > 0 ? vertexCount : 1) );
+	tess->elements = (TESSindex*)alloc->memalloc( alloc->userData,
+		sizeof(TESSindex) * elementSize * (elementCount > 0 ? elementCount : 1) );
+	if( tess->vertices == NULL || tess->vertexIndices == NULL || tess->elements == NULL ) {
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return 0;
+	}
+	tess->vertexCount = vertexCount;
+	tess->elementCount = elementCount;
+
+	vbase = ebase = 0;
+	for( i = 0; i < partCount; ++i ) {
+		const TESStesselator *pt = parts[i].tess;
+		TESSindex *dst = tess->elements + ebase * elementSize;
+
+		memcpy( tess->vertices + vbase * vertexSize, pt->vertices,
+				sizeof(TESSreal) * vertexSize * pt->vertexCount );
+		memcpy( tess->vertexIndices + vbase, pt->vertexIndices,
+				sizeof(TESSindex) * pt->vertexCount );
+
+		for( j = 0; j < pt->elementCount; ++j ) {
+			const TESSindex *src = pt->elements + j * elementSize;
+			TESSindex *elem = dst + j * elementSize;
+			if( params->elementType == TESS_BOUNDARY_CONTOURS ) {
+				elem[0] = src[0] + vbase;
+				elem[1] = src[1];
+				continue;
+			}
+			for( k = 0; k < polySize; ++k )
+				elem[k] = src[k] != TESS_UNDEF ? src[k] + vbase : TESS_UNDEF;
+			if( params->elementType == TESS_CONNECTED_POLYGONS ) {
+				for( k = polySize; k < polySize*2; ++k )
+					elem[k] = src[k] != TESS_UNDEF ? src[k] + ebase : TESS_UNDEF;
+			}
+		}
+
+		vbase += pt->vertexCount;
+		ebase += pt->elementCount;
+	}
+
+	return 1;
+}
+
+/* Splits the input of the item into independent parts and tessellates
+* them in parallel.  Returns 0 if the input was not split, in which case
+* it is left for tessTesselate().  Grouped output is never split, as the
+* groups are ordered over the whole output. */
+static int TesselateSplit( TessBatchItem *item )
+{
+	TESStesselator *tess = item->tess;
+	TESSscheduler *sched = item->sched;
+	const TessBatchParams *params = item->params;
+	TessContourRef *refs = NULL;
+	unsigned char *first = NULL;
+	TessBatchPart *parts = NULL;
+	TessTaskGroup group;
+	double start;
+	int contourCount, partCount, target, size, i, j;
+
+	if( sched == NULL || sched->threadCount == 0 || item->size < TESS_BATCH_SPLIT_MIN
+		|| tess->mesh == NULL || tess->error != TESS_ERROR_NONE || tess->groupedOutput )
+		return 0;
+
+	if( tess->tracer != NULL )
+		tess->traceCall = tessTraceNextCall( tess->tracer );
+	start = tessTimeSeconds();
+	if( params->normal ) {
+		tess->normal[0] = params->normal[0];
+		tess->normal[1] = params->normal[1];
+		tess->normal[2] = params->normal[2];
+	}
+	tessProjectPolygon( tess );
+
+	contourCount = CollectContours( tess, &refs );
+	if( contourCount < 2 )
+		goto nosplit;
+
+	first = (unsigned char*)tess->alloc.memalloc( tess->alloc.userData, contourCount );
+	if( first == NULL )
+		goto nosplit;
+	memset( first, 0, contourCount );
+	first[0] = 1;
+	/* Cut along the sweep direction first, so that each slab covers
+	* a shorter range of the sweep. */
+	PartitionContours( refs, contourCount, first, 0, 1, 0 );
+
+	target = item->size / (4 * (sched->threadCount + 1));
+	if( target < TESS_BATCH_PART_MIN )
+		target = TESS_BATCH_PART_MIN;
+
+	/* Pack the pieces into parts of at least 'target' vertices. */
+	partCount = 0;
+	size = 0;
+	for( i = 0; i < contourCount; ++i ) {
+		if( first[i] && size >= target ) {
+			partCount++;
+			size = 0;
+		}
+		size += refs[i].count;
+	}
+	partCount++;
+	if( partCount < 2 )
+		goto nosplit;
+
+	parts = (TessBatchPart*)tess->alloc.memalloc( tess->alloc.userData, sizeof(TessBatchPart) * partCount );
+	if( parts == NULL )
+		goto nosplit;
+
+	j = 0;
+	size = 0;
+	parts[0].contours = refs;
+	for( i = 0; i < contourCount; ++i ) {
+		if( first[i] && size >= target ) {
+			parts[j].contourCount = (int)(&refs[i] - parts[j].contours);
+			parts[++j].contours = &refs[i];
+			size = 0;
+		}
+		size += refs[i].count;
+	}
+	parts[j].contourCount = (int)(&refs[contourCount] - parts[j].contours);
+
+	tessTaskGroupInit( &group );
+	for( i = 0; i < partCount; ++i ) {
+		parts[i].item = item;
+		parts[i].tess = NULL;
+		parts[i].result = 0;
+		tessSchedulerSpawn( sched, &group, &parts[i].task, TesselatePart, &parts[i] );
+	}
+	tessSchedulerWait( sched, &group );
+
+	/* Replace the previous output, as tessTesselate() would. */
+	if( tess->vertices != NULL ) {
+		tess->alloc.memfree( tess->alloc.userData, tess->vertices );
+		tess->vertices = 0;
+	}
+	if( tess->vertexIndices != NULL ) {
+		tess->alloc.memfree( tess->alloc.userData, tess->vertexIndices );
+		tess->vertexIndices = 0;
+	}
+	if( tess->elements != NULL ) {
+		tess->alloc.memfree( tess->alloc.userData, tess->elements );
+		tess->elements = 0;
+	}
+	tess->vertexCount = 0;
+	tess->elementCount = 0;
+	tess->vertexIndexCounter = 0;
+	tess->windingRule = params->windingRule;
+
+	item->result = MergeParts( item, parts, partCount );
+	TESS_TRACE_END( tess, "tessTesselate", start );
+
+	if( tess->capture != NULL )
+		tessCaptureTesselate( tess, params->windingRule, params->elementType, params->polySize,
+							  params->vertexSize, params->normal, item->result,
+							  tessTimeSeconds() - start );
+
+	for( i = 0; i < partCount; ++i ) {
+		if( parts[i].tess != NULL )
+			tessDeleteTess( parts[i].tess );
+	}
+	tess->alloc.memfree( tess->alloc.userData, parts );
+	tess->alloc.memfree( tess->alloc.userData, first );
+	tess->alloc.memfree( tess->alloc.userData, refs );
+
+	/* The contours are consumed either way. */
+	tessMeshDeleteMesh( &tess->alloc, tess->mesh );
+	tess->mesh = NULL;
+
+	return 1;
+
+nosplit:
+	if( first != NULL )
+		tess->alloc.memfree( tess->alloc.userData, first );
+	if( refs != NULL )
+		tess->alloc.memfree( tess->alloc.userData, refs );
+	return 0;
+}
+
+static void TesselateItem( void *data )
+{
+	TessBatchItem *item = (TessBatchItem*)data;
+	const TessBatchParams *params = item->params;
+
+	if( TesselateSplit( item ) )
+		return;
+	item->result = tessTesselate( item->tess, params->windingRule, params->elementType,
+								  params->polySize, params->vertexSize, params->normal );
+}
+
+int tessTesselateBatch( TESSscheduler* sched, TESStesselator** tess, int count,
+						int windingRule, int elementType, int polySize, int vertexSize,
+						const TESSreal* normal )
+{
+	TessBatchParams params;
+	TessBatchItem *items;
+	TessTaskGroup group;
+	int i, n, result = 1;
+
+	params.windingRule = windingRule;
+	params.elementType = elementType;
+	params.polySize = polySize;
+	params.vertexSize = vertexSize;
+	params.normal = normal;
+
+	if( sched == NULL || sched->threadCount == 0 ) {
+		for( i = 0; i < count; ++i ) {
+			if( tess[i] != NULL && !tessTesselate( tess[i], windingRule, elementType, polySize, vertexSize, normal ) )
+				result = 0;
+		}
+		return result;
+	}
+
+	items = (TessBatchItem*)sched->alloc.memalloc( sched->alloc.userData, sizeof(TessBatchItem) * (count > 0 ? count : 1) );
+	if( items == NULL )
+		return 0;
+
+	n = 0;
+	for( i = 0; i < count; ++i ) {
+		if( tess[i] == NULL ) continue;
+		items[n].sched = sched;
+		items[n].tess = tess[i];
+		items[n].params = &params;
+		items[n].size = CountVertices( tess[i]->mesh );
+		items[n].result = 0;
+		n++;
+	}
+
+	/* The oldest tasks are stolen first, so spawn the largest first. */
+	qsort( items, n, sizeof(TessBatchItem), CompareItemSize );
+
+	tessTaskGroupInit( &group );
+	for( i = 0; i < n; ++i )
+		tessSchedulerSpawn( sched, &group, &items[i].task, TesselateItem, &items[i] );
+	tessSchedulerWait( sched, &group );
+
+	for( i = 0; i < n; ++i ) {
+		if( !items[i].result )
+			result = 0;
+	}
+	sched->alloc.memfree( sched->alloc.userData, items );
+
+	return result;
+}
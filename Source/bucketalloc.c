@@ -35,12 +35,20 @@
 
 //#define CHECK_BOUNDS
 
+// Growing allocators (TESSalloc::adaptiveBuckets) start from MIN_BUCKET_SIZE
+// to MAX_FIRST_SIZE items and double the size of each new bucket, up to
+// MAX_GROW_SIZE items.
+#define MIN_BUCKET_SIZE 16
+#define MAX_FIRST_SIZE (1 << 20)
+#define MAX_GROW_SIZE 65536
+
 typedef struct BucketAlloc BucketAlloc;
 typedef struct Bucket Bucket;
 
 struct Bucket
 {
 	Bucket *next;
+	unsigned int size;	// number of items
 };
 
 struct BucketAlloc
@@ -48,9 +56,14 @@ struct BucketAlloc
 	void *freelist;
 	Bucket *buckets;
 	unsigned int itemSize;
-	unsigned int bucketSize;
+	unsigned int bucketSize;	// size of the next bucket
+	int grow;
 	const char *name;
 	TESSalloc* alloc;
+	int liveCount;		// items in use
+	int peakCount;		// most items in use since the last bucketAllocStats()
+	int bucketCount;
+	int bytes;			// allocated for the buckets
 };
 
 static int CreateBucket( struct BucketAlloc* ba )
@@ -67,10 +80,13 @@ static int CreateBucket( struct BucketAlloc* ba )
 	if ( !bucket )
 		return 0;
 	bucket->next = 0;
+	bucket->size = ba->bucketSize;
 
 	// Add the bucket into the list of buckets.
 	bucket->next = ba->buckets;
 	ba->buckets = bucket;
+	ba->bucketCount++;
+	ba->bytes += (int)size;
 
 	// Add new items to the free list.
 	freelist = ba->freelist;
@@ -88,6 +104,9 @@ static int CreateBucket( struct BucketAlloc* ba )
 	// Update pointer to next location containing a free item.
 	ba->freelist = (void*)it;
 
+	if ( ba->grow )
+		ba->bucketSize = ba->bucketSize < MAX_GROW_SIZE/2 ? ba->bucketSize*2 : MAX_GROW_SIZE;
+
 	return 1;
 }
 
@@ -100,15 +119,26 @@ struct BucketAlloc* createBucketAlloc( TESSalloc* alloc, const char* name,
 									  unsigned int itemSize, unsigned int bucketSize )
 {
 	BucketAlloc* ba = (BucketAlloc*)alloc->memalloc( alloc->userData, sizeof(BucketAlloc) );
+	if ( !ba )
+		return 0;
 
 	ba->alloc = alloc;
 	ba->name = name;
 	ba->itemSize = itemSize;
 	if ( ba->itemSize < sizeof(void*) )
 		ba->itemSize = sizeof(void*);
+	ba->grow = alloc->adaptiveBuckets != 0;
+	if ( ba->grow && bucketSize < MIN_BUCKET_SIZE )
+		bucketSize = MIN_BUCKET_SIZE;
+	if ( ba->grow && bucketSize > MAX_FIRST_SIZE )
+		bucketSize = MAX_FIRST_SIZE;
 	ba->bucketSize = bucketSize;
 	ba->freelist = 0;
 	ba->buckets = 0;
+	ba->liveCount = 0;
+	ba->peakCount = 0;
+	ba->bucketCount = 0;
+	ba->bytes = 0;
 
 	if ( !CreateBucket( ba ) )
 	{
@@ -134,6 +164,9 @@ void* bucketAlloc( struct BucketAlloc *ba )
 	it = ba->freelist;
 	ba->freelist = NextFreeItem( ba );
 
+	if ( ++ba->liveCount > ba->peakCount )
+		ba->peakCount = ba->liveCount;
+
 	return it;
 }
 
@@ -148,7 +181,7 @@ void bucketFree( struct BucketAlloc *ba, void *ptr )
 	while ( bucket )
 	{
 		void *bucketMin = (void*)((unsigned char*)bucket + sizeof(Bucket));
-		void *bucketMax = (void*)((unsigned char*)bucket + sizeof(Bucket) + ba->itemSize * ba->bucketSize);
+		void *bucketMax = (void*)((unsigned char*)bucket + sizeof(Bucket) + ba->itemSize * bucket->size);
 		if ( ptr >= bucketMin && ptr < bucketMax )
 		{
 			inBounds = 1;
@@ -162,6 +195,7 @@ void bucketFree( struct BucketAlloc *ba, void *ptr )
 		// Add the node in front of the free list.
 		*(void**)ptr = ba->freelist;
 		ba->freelist = ptr;
+		ba->liveCount--;
 	}
 	else
 	{
@@ -171,14 +205,56 @@ void bucketFree( struct BucketAlloc *ba, void *ptr )
 	// Add the node in front of the free list.
 	*(void**)ptr = ba->freelist;
 	ba->freelist = ptr;
+	ba->liveCount--;
 #endif
 }
 
+void bucketAllocMerge( struct BucketAlloc *dst, struct BucketAlloc *src )
+{
+	TESSalloc* alloc = src->alloc;
+	Bucket *bucket;
+	void **it;
+
+	// Put the buckets of src in front of the buckets of dst.
+	if ( src->buckets )
+	{
+		bucket = src->buckets;
+		while ( bucket->next )
+			bucket = bucket->next;
+		bucket->next = dst->buckets;
+		dst->buckets = src->buckets;
+	}
+
+	// Same for the free items. Usually only the end of the last bucket is free.
+	if ( src->freelist )
+	{
+		it = (void**)src->freelist;
+		while ( *it )
+			it = (void**)*it;
+		*it = dst->freelist;
+		dst->freelist = src->freelist;
+	}
+
+	dst->liveCount += src->liveCount;
+	dst->bucketCount += src->bucketCount;
+	dst->bytes += src->bytes;
+	if ( src->peakCount > dst->peakCount )
+		dst->peakCount = src->peakCount;
+	if ( dst->liveCount > dst->peakCount )
+		dst->peakCount = dst->liveCount;
+
+	alloc->memfree( alloc->userData, src );
+}
+
 void deleteBucketAlloc( struct BucketAlloc *ba )
 {
-	TESSalloc* alloc = ba->alloc;
-	Bucket *bucket = ba->buckets;
+	TESSalloc* alloc;
+	Bucket *bucket;
 	Bucket *next;
+	if ( !ba )
+		return;
+	alloc = ba->alloc;
+	bucket = ba->buckets;
 	while ( bucket )
 	{
 		next = bucket->next;
@@ -189,3 +265,18 @@ void deleteBucketAlloc( struct BucketAlloc *ba )
 	ba->buckets = 0;
 	alloc->memfree( alloc->userData, ba );
 }
+
+void bucketAllocStats( struct BucketAlloc *ba, TESSbucketStats *stats )
+{
+	stats->name = ba->name;
+	stats->itemSize = (int)ba->itemSize;
+	stats->bucketSize = ba->buckets ? (int)ba->buckets->size : (int)ba->bucketSize;
+	stats->liveItems = ba->liveCount;
+	if ( ba->peakCount > stats->peakItems )
+		stats->peakItems = ba->peakCount;
+	if ( ba->bucketCount > stats->bucketCount )
+		stats->bucketCount = ba->bucketCount;
+	if ( ba->bytes > stats->bytes )
+		stats->bytes = ba->bytes;
+	ba->peakCount = ba->liveCount;
+}
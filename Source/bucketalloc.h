@@ -42,7 +42,13 @@ struct BucketAlloc *createBucketAlloc( TESSalloc* alloc, const char *name,
 									  unsigned int itemSize, unsigned int bucketSize );
 void *bucketAlloc( struct BucketAlloc *ba);
 void bucketFree( struct BucketAlloc *ba, void *ptr );
+/* Moves the buckets and free items of 'src' to 'dst' and deletes 'src'.
+* Both must have the same item size and memory allocator. */
+void bucketAllocMerge( struct BucketAlloc *dst, struct BucketAlloc *src );
 void deleteBucketAlloc( struct BucketAlloc *ba );
+/* Updates 'stats' with the usage of the allocator, keeping the larger peak,
+* bucket count and size, and starts measuring a new peak. */
+void bucketAllocStats( struct BucketAlloc *ba, TESSbucketStats *stats );
 
 #ifdef __cplusplus
 };
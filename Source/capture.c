@@ -0,0 +1,244 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include "capture.h"
+
+/* Records are written straight to the file.  The size of each record is
+* known before it is written, so the trace stays within the limit: when a
+* record does not fit, a truncation record (kept in reserve) is written
+* instead and the capture stops.
+*/
+
+#define CAPTURE_RECORD_HEADER	(2 * sizeof(int))
+
+struct TessCapture {
+	FILE *fp;
+	long size;		/* bytes written so far */
+	long maxSize;	/* 0 if unlimited */
+};
+
+static void CaptureClose( TESStesselator *tess )
+{
+	TessCapture *cap = tess->capture;
+	fclose( cap->fp );
+	tess->alloc.memfree( tess->alloc.userData, cap );
+	tess->capture = NULL;
+}
+
+static void WriteInts( TessCapture *cap, const int *values, int count )
+{
+	fwrite( values, sizeof(int), count, cap->fp );
+	cap->size += (long)(sizeof(int) * count);
+}
+
+static void WriteReals( TessCapture *cap, const TESSreal *values, int count )
+{
+	fwrite( values, sizeof(TESSreal), count, cap->fp );
+	cap->size += (long)(sizeof(TESSreal) * count);
+}
+
+/* Writes the header of a record with "bytes" of payload, or returns 0 if
+* the record does not fit, in which case the capture has been stopped. */
+static int BeginRecord( TESStesselator *tess, int type, long bytes )
+{
+	TessCapture *cap = tess->capture;
+	int header[2];
+
+	if( cap->maxSize > 0
+		&& cap->size + (long)CAPTURE_RECORD_HEADER * 2 + bytes > cap->maxSize ) {
+		header[0] = TESS_CAPTURE_TRUNCATED;
+		header[1] = 0;
+		WriteInts( cap, header, 2 );
+		CaptureClose( tess );
+		return 0;
+	}
+	header[0] = type;
+	header[1] = (int)bytes;
+	WriteInts( cap, header, 2 );
+	return 1;
+}
+
+static void WriteVertices( TessCapture *cap, int size, const void* vertices, int stride, int count )
+{
+	const unsigned char *src = (const unsigned char*)vertices;
+	int i;
+
+	for( i = 0; i < count; ++i )
+		WriteReals( cap, (const TESSreal*)(src + i*stride), size );
+}
+
+void tessCaptureContour( TESStesselator *tess, int size, const void* vertices, int stride, int count )
+{
+	int values[2];
+
+	if ( size < 2 )
+		size = 2;
+	if ( size > 3 )
+		size = 3;
+	if ( count < 0 )
+		count = 0;
+	if( !BeginRecord( tess, TESS_CAPTURE_CONTOUR, (long)sizeof(int) * 2 + (long)sizeof(TESSreal) * count * size ))
+		return;
+	values[0] = size;
+	values[1] = count;
+	WriteInts( tess->capture, values, 2 );
+	WriteVertices( tess->capture, size, vertices, stride, count );
+}
+
+void tessCaptureOffsetContour( TESStesselator *tess, int size, const void* vertices, int stride, int count,
+							   TESSreal offset, int joinType, TESSreal miterLimit, TESSreal arcTolerance )
+{
+	int values[3];
+	TESSreal params[3];
+
+	if ( size < 2 )
+		size = 2;
+	if ( size > 3 )
+		size = 3;
+	if ( count < 0 )
+		count = 0;
+	if( !BeginRecord( tess, TESS_CAPTURE_OFFSET_CONTOUR,
+					  (long)sizeof(int) * 3 + (long)sizeof(TESSreal) * (3 + count * size) ))
+		return;
+	values[0] = size;
+	values[1] = count;
+	values[2] = joinType;
+	params[0] = offset;
+	params[1] = miterLimit;
+	params[2] = arcTolerance;
+	WriteInts( tess->capture, values, 3 );
+	WriteReals( tess->capture, params, 3 );
+	WriteVertices( tess->capture, size, vertices, stride, count );
+}
+
+void tessCapturePath( TESStesselator *tess, const unsigned char* commands, int commandCount,
+					  const TESSreal* coords, int coordCount, TESSreal tolerance )
+{
+	static const unsigned char pad[4] = { 0, 0, 0, 0 };
+	int values[2];
+	int padded = (commandCount + 3) & ~3;
+
+	if( !BeginRecord( tess, TESS_CAPTURE_PATH,
+					  (long)sizeof(int) * 2 + (long)sizeof(TESSreal) * (1 + coordCount) + padded ))
+		return;
+	values[0] = commandCount;
+	values[1] = coordCount;
+	WriteInts( tess->capture, values, 2 );
+	WriteReals( tess->capture, &tolerance, 1 );
+	fwrite( commands, 1, commandCount, tess->capture->fp );
+	fwrite( pad, 1, padded - commandCount, tess->capture->fp );
+	tess->capture->size += padded;
+	WriteReals( tess->capture, coords, coordCount );
+}
+
+void tessCaptureOption( TESStesselator *tess, int option, int value )
+{
+	int values[2];
+
+	if( !BeginRecord( tess, TESS_CAPTURE_OPTION, (long)sizeof(int) * 2 ))
+		return;
+	values[0] = option;
+	values[1] = value;
+	WriteInts( tess->capture, values, 2 );
+}
+
+void tessCaptureClipRect( TESStesselator *tess, const TESSreal* rect )
+{
+	if( !BeginRecord( tess, TESS_CAPTURE_CLIP_RECT, (long)sizeof(TESSreal) * 4 ))
+		return;
+	WriteReals( tess->capture, rect, 4 );
+}
+
+void tessCaptureTesselate( TESStesselator *tess, int windingRule, int elementType, int polySize,
+						   int vertexSize, const TESSreal* normal, int result, double seconds )
+{
+	int values[5];
+	TESSreal n[3] = { 0, 0, 0 };
+	TESSreal t = (TESSreal)seconds;
+
+	if( !BeginRecord( tess, TESS_CAPTURE_TESSELATE, (long)sizeof(int) * 8 + (long)sizeof(TESSreal) * 4 ))
+		return;
+	values[0] = windingRule;
+	values[1] = elementType;
+	values[2] = polySize;
+	values[3] = vertexSize;
+	values[4] = normal != NULL;
+	WriteInts( tess->capture, values, 5 );
+	if( normal != NULL ) {
+		n[0] = normal[0];
+		n[1] = normal[1];
+		n[2] = normal[2];
+	}
+	WriteReals( tess->capture, n, 3 );
+	values[0] = result;
+	values[1] = tess->vertexCount;
+	values[2] = tess->elementCount;
+	WriteInts( tess->capture, values, 3 );
+	WriteReals( tess->capture, &t, 1 );
+	/* Make each completed call available even if the process dies later. */
+	fflush( tess->capture->fp );
+}
+
+void tessCaptureUnrecorded( TESStesselator *tess )
+{
+	BeginRecord( tess, TESS_CAPTURE_UNRECORDED, 0 );
+}
+
+int tessBeginCapture( TESStesselator *tess, const char* path, int maxSize )
+{
+	TessCapture *cap;
+	int header[1];
+
+	tessEndCapture( tess );
+
+	cap = (TessCapture*)tess->alloc.memalloc( tess->alloc.userData, sizeof(TessCapture) );
+	if( cap == NULL )
+		return 0;
+	cap->fp = fopen( path, "wb" );
+	if( cap->fp == NULL ) {
+		tess->alloc.memfree( tess->alloc.userData, cap );
+		return 0;
+	}
+	cap->size = 0;
+	cap->maxSize = maxSize > 0 ? maxSize : 0;
+	tess->capture = cap;
+
+	fwrite( "TESR", 1, 4, cap->fp );
+	cap->size += 4;
+	header[0] = TESS_CAPTURE_VERSION;
+	WriteInts( cap, header, 1 );
+	return 1;
+}
+
+void tessEndCapture( TESStesselator *tess )
+{
+	if( tess->capture != NULL )
+		CaptureClose( tess );
+}
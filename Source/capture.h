@@ -0,0 +1,91 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+**
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "tess.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A capture records the calls made to a tesselator into a trace file
+* (see tessBeginCapture()), so that the same calls can be replayed later.
+* The trace starts with the magic "TESR" and a version number, followed
+* by records of a type and a payload size in bytes, all 32-bit values in
+* native byte order.  The payloads are:
+*
+*  TESS_CAPTURE_CONTOUR         size, count, coords[count*size]
+*  TESS_CAPTURE_OFFSET_CONTOUR  size, count, joinType, offset, miterLimit,
+*                               arcTolerance, coords[count*size]
+*  TESS_CAPTURE_PATH            commandCount, coordCount, tolerance,
+*                               commands[commandCount] padded to 4 bytes,
+*                               coords[coordCount]
+*  TESS_CAPTURE_OPTION          option, value
+*  TESS_CAPTURE_CLIP_RECT       minx, miny, maxx, maxy
+*  TESS_CAPTURE_TESSELATE       windingRule, elementType, polySize,
+*                               vertexSize, hasNormal, normal[3], result,
+*                               vertexCount, elementCount, seconds
+*  TESS_CAPTURE_UNRECORDED      nothing, marks a call which adds input
+*                               that cannot be replayed (tessAddLodPath())
+*  TESS_CAPTURE_TRUNCATED       nothing, the size limit was reached
+*
+* The hooks below must only be called when tess->capture is set.
+*/
+
+#define TESS_CAPTURE_VERSION	1
+
+enum TessCaptureRecord
+{
+	TESS_CAPTURE_CONTOUR = 1,
+	TESS_CAPTURE_OFFSET_CONTOUR,
+	TESS_CAPTURE_PATH,
+	TESS_CAPTURE_OPTION,
+	TESS_CAPTURE_CLIP_RECT,
+	TESS_CAPTURE_TESSELATE,
+	TESS_CAPTURE_UNRECORDED,
+	TESS_CAPTURE_TRUNCATED,
+};
+
+void tessCaptureContour( TESStesselator *tess, int size, const void* vertices, int stride, int count );
+void tessCaptureOffsetContour( TESStesselator *tess, int size, const void* vertices, int stride, int count,
+							   TESSreal offset, int joinType, TESSreal miterLimit, TESSreal arcTolerance );
+void tessCapturePath( TESStesselator *tess, const unsigned char* commands, int commandCount,
+					  const TESSreal* coords, int coordCount, TESSreal tolerance );
+void tessCaptureOption( TESStesselator *tess, int option, int value );
+void tessCaptureClipRect( TESStesselator *tess, const TESSreal* rect );
+void tessCaptureTesselate( TESStesselator *tess, int windingRule, int elementType, int polySize,
+						   int vertexSize, const TESSreal* normal, int result, double seconds );
+void tessCaptureUnrecorded( TESStesselator *tess );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -34,6 +34,137 @@
 #include "bucketalloc.h"
 #include "dict.h"
 
+#ifdef TESS_DICT_ARRAY
+
+Dict *dictNewDict( TESSalloc* alloc, void *frame, int (*leq)(void *frame, DictKey key1, DictKey key2) )
+{
+	Dict *dict = (Dict *)alloc->memalloc( alloc->userData, sizeof( Dict ));
+	DictNode *head;
+
+	if (dict == NULL) return NULL;
+
+	if (alloc->dictNodeBucketSize < 16)
+		alloc->dictNodeBucketSize = 16;
+	if (alloc->dictNodeBucketSize > 4096)
+		alloc->dictNodeBucketSize = 4096;
+
+	dict->capacity = alloc->dictNodeBucketSize;
+	dict->nodes = (DictNode **)alloc->memalloc( alloc->userData, dict->capacity * sizeof( DictNode * ));
+	if (dict->nodes == NULL) {
+		alloc->memfree( alloc->userData, dict );
+		return NULL;
+	}
+
+	head = &dict->head;
+	head->key = NULL;
+	head->dict = dict;
+	head->index = 0;
+
+	dict->nodes[0] = head;
+	dict->nodes[1] = head;
+	dict->count = 0;
+	dict->searchSteps = 0;
+	dict->alloc = alloc;
+	dict->frame = frame;
+	dict->leq = leq;
+	dict->nodePool = createBucketAlloc( alloc, "Dict", sizeof(DictNode),
+									   alloc->adaptiveBuckets ? 0 : alloc->dictNodeBucketSize );
+	if (dict->nodePool == NULL) {
+		alloc->memfree( alloc->userData, dict->nodes );
+		alloc->memfree( alloc->userData, dict );
+		return NULL;
+	}
+
+	return dict;
+}
+
+void dictDeleteDict( TESSalloc* alloc, Dict *dict )
+{
+	deleteBucketAlloc( dict->nodePool );
+	alloc->memfree( alloc->userData, dict->nodes );
+	alloc->memfree( alloc->userData, dict );
+}
+
+DictNode *dictInsertBefore( Dict *dict, DictNode *node, DictKey key )
+{
+	DictNode *newNode, **nodes;
+	int i, pos;
+
+	/* Same walk as the list version: back up from "node" until we find
+	* a key which is <= the new one, and insert after it.
+	*/
+	pos = (node == &dict->head) ? dict->count + 1 : node->index;
+	do {
+		--pos;
+	} while( pos > 0 && ! (*dict->leq)(dict->frame, dict->nodes[pos]->key, key));
+	++pos;
+
+	if( dict->count + 2 >= dict->capacity ) {
+		TESSalloc *alloc = dict->alloc;
+		if (!alloc->memrealloc) return NULL;
+		nodes = (DictNode **)alloc->memrealloc( alloc->userData, dict->nodes,
+											   dict->capacity * 2 * sizeof( DictNode * ));
+		if (nodes == NULL) return NULL;
+		dict->nodes = nodes;
+		dict->capacity *= 2;
+	}
+
+	newNode = (DictNode *)bucketAlloc( dict->nodePool );
+	if (newNode == NULL) return NULL;
+
+	newNode->key = key;
+	newNode->dict = dict;
+
+	/* Shift the tail (including the trailing head) up by one. */
+	nodes = dict->nodes;
+	dict->count++;
+	for( i = dict->count + 1; i > pos; --i ) {
+		nodes[i] = nodes[i-1];
+		nodes[i]->index = i;
+	}
+	nodes[pos] = newNode;
+	newNode->index = pos;
+	dict->head.index = 0;
+
+	return newNode;
+}
+
+void dictDelete( Dict *dict, DictNode *node )
+{
+	DictNode **nodes = dict->nodes;
+	int i;
+
+	for( i = node->index; i <= dict->count; ++i ) {
+		nodes[i] = nodes[i+1];
+		nodes[i]->index = i;
+	}
+	dict->count--;
+	dict->head.index = 0;
+	bucketFree( dict->nodePool, node );
+}
+
+DictNode *dictSearch( Dict *dict, DictKey key )
+{
+	DictNode **nodes = dict->nodes;
+	int lo = 1, hi = dict->count + 1, mid;
+
+	/* Find the first node whose key is >= the given key; nodes[count+1]
+	* is the head, which stops the search with a NULL key.
+	*/
+	while( lo < hi ) {
+		dict->searchSteps++;
+		mid = (lo + hi) >> 1;
+		if( (*dict->leq)(dict->frame, key, nodes[mid]->key) ) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return nodes[lo];
+}
+
+#else
+
 /* really tessDictListNewDict */
 Dict *dictNewDict( TESSalloc* alloc, void *frame, int (*leq)(void *frame, DictKey key1, DictKey key2) )
 {
@@ -48,6 +179,7 @@ Dict *dictNewDict( TESSalloc* alloc, void *frame, int (*leq)(void *frame, DictKe
 	head->next = head;
 	head->prev = head;
 
+	dict->searchSteps = 0;
 	dict->frame = frame;
 	dict->leq = leq;
 
@@ -55,7 +187,12 @@ Dict *dictNewDict( TESSalloc* alloc, void *frame, int (*leq)(void *frame, DictKe
 		alloc->dictNodeBucketSize = 16;
 	if (alloc->dictNodeBucketSize > 4096)
 		alloc->dictNodeBucketSize = 4096;
-	dict->nodePool = createBucketAlloc( alloc, "Dict", sizeof(DictNode), alloc->dictNodeBucketSize );
+	dict->nodePool = createBucketAlloc( alloc, "Dict", sizeof(DictNode),
+									   alloc->adaptiveBuckets ? 0 : alloc->dictNodeBucketSize );
+	if (dict->nodePool == NULL) {
+		alloc->memfree( alloc->userData, dict );
+		return NULL;
+	}
 
 	return dict;
 }
@@ -102,8 +239,11 @@ DictNode *dictSearch( Dict *dict, DictKey key )
 	DictNode *node = &dict->head;
 
 	do {
+		dict->searchSteps++;
 		node = node->next;
 	} while( node->key != NULL && ! (*dict->leq)(dict->frame, key, node->key));
 
 	return node;
 }
+
+#endif
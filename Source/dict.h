@@ -49,15 +49,59 @@ DictNode *dictInsertBefore( Dict *dict, DictNode *node, DictKey key );
 void dictDelete( Dict *dict, DictNode *node );
 
 #define dictKey(n)	((n)->key)
+#define dictInsert(d,k) (dictInsertBefore((d),&(d)->head,(k)))
+
+#ifdef TESS_DICT_ARRAY
+
+/* The array dictionary keeps the nodes in a contiguous, sorted array,
+* which suits the small sweep widths of typical inputs better than chasing
+* list pointers, and lets dictSearch() bisect instead of scanning.  Nodes
+* are still allocated individually, so DictNode pointers stay valid as
+* stable handles while the array shifts underneath them.
+*
+* nodes[0] and nodes[count+1] both hold the head, so Succ(Max(d)) and
+* Pred(Min(d)) have a NULL key as in the list version.  The head itself
+* only supports Succ().
+*/
+#define dictSucc(n)	((n)->dict->nodes[(n)->index + 1])
+#define dictPred(n)	((n)->dict->nodes[(n)->index - 1])
+#define dictMin(d)	((d)->nodes[1])
+#define dictMax(d)	((d)->nodes[(d)->count])
+
+#else
+
 #define dictSucc(n)	((n)->next)
 #define dictPred(n)	((n)->prev)
 #define dictMin(d)	((d)->head.next)
 #define dictMax(d)	((d)->head.prev)
-#define dictInsert(d,k) (dictInsertBefore((d),&(d)->head,(k)))
+
+#endif
 
 
 /*** Private data structures ***/
 
+#ifdef TESS_DICT_ARRAY
+
+struct DictNode {
+	DictKey	key;
+	Dict *dict;
+	int index;		/* position in dict->nodes */
+};
+
+struct Dict {
+	DictNode head;
+	DictNode **nodes;
+	int count;
+	int capacity;
+	int searchSteps;	/* comparisons made by dictSearch(), for statistics */
+	TESSalloc *alloc;
+	void *frame;
+	struct BucketAlloc *nodePool;
+	int (*leq)(void *frame, DictKey key1, DictKey key2);
+};
+
+#else
+
 struct DictNode {
 	DictKey	key;
 	DictNode *next;
@@ -66,9 +110,12 @@ struct DictNode {
 
 struct Dict {
 	DictNode head;
+	int searchSteps;	/* comparisons made by dictSearch(), for statistics */
 	void *frame;
 	struct BucketAlloc *nodePool;
 	int (*leq)(void *frame, DictKey key1, DictKey key2);
 };
 
 #endif
+
+#endif
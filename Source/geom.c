@@ -35,130 +35,6 @@
 #include "geom.h"
 #include <math.h>
 
-int tesvertLeq( TESSvertex *u, TESSvertex *v )
-{
-	/* Returns TRUE if u is lexicographically <= v. */
-
-	return VertLeq( u, v );
-}
-
-TESSreal tesedgeEval( TESSvertex *u, TESSvertex *v, TESSvertex *w )
-{
-	/* Given three vertices u,v,w such that VertLeq(u,v) && VertLeq(v,w),
-	* evaluates the t-coord of the edge uw at the s-coord of the vertex v.
-	* Returns v->t - (uw)(v->s), ie. the signed distance from uw to v.
-	* If uw is vertical (and thus passes thru v), the result is zero.
-	*
-	* The calculation is extremely accurate and stable, even when v
-	* is very close to u or w.  In particular if we set v->t = 0 and
-	* let r be the negated result (this evaluates (uw)(v->s)), then
-	* r is guaranteed to satisfy MIN(u->t,w->t) <= r <= MAX(u->t,w->t).
-	*/
-	TESSreal gapL, gapR;
-
-	assert( VertLeq( u, v ) && VertLeq( v, w ));
-
-	gapL = v->s - u->s;
-	gapR = w->s - v->s;
-
-	if( gapL + gapR > 0 ) {
-		if( gapL < gapR ) {
-			return (v->t - u->t) + (u->t - w->t) * (gapL / (gapL + gapR));
-		} else {
-			return (v->t - w->t) + (w->t - u->t) * (gapR / (gapL + gapR));
-		}
-	}
-	/* vertical line */
-	return 0;
-}
-
-TESSreal tesedgeSign( TESSvertex *u, TESSvertex *v, TESSvertex *w )
-{
-	/* Returns a number whose sign matches EdgeEval(u,v,w) but which
-	* is cheaper to evaluate.  Returns > 0, == 0 , or < 0
-	* as v is above, on, or below the edge uw.
-	*/
-	TESSreal gapL, gapR;
-
-	assert( VertLeq( u, v ) && VertLeq( v, w ));
-
-	gapL = v->s - u->s;
-	gapR = w->s - v->s;
-
-	if( gapL + gapR > 0 ) {
-		return (v->t - w->t) * gapL + (v->t - u->t) * gapR;
-	}
-	/* vertical line */
-	return 0;
-}
-
-
-/***********************************************************************
-* Define versions of EdgeSign, EdgeEval with s and t transposed.
-*/
-
-TESSreal testransEval( TESSvertex *u, TESSvertex *v, TESSvertex *w )
-{
-	/* Given three vertices u,v,w such that TransLeq(u,v) && TransLeq(v,w),
-	* evaluates the t-coord of the edge uw at the s-coord of the vertex v.
-	* Returns v->s - (uw)(v->t), ie. the signed distance from uw to v.
-	* If uw is vertical (and thus passes thru v), the result is zero.
-	*
-	* The calculation is extremely accurate and stable, even when v
-	* is very close to u or w.  In particular if we set v->s = 0 and
-	* let r be the negated result (this evaluates (uw)(v->t)), then
-	* r is guaranteed to satisfy MIN(u->s,w->s) <= r <= MAX(u->s,w->s).
-	*/
-	TESSreal gapL, gapR;
-
-	assert( TransLeq( u, v ) && TransLeq( v, w ));
-
-	gapL = v->t - u->t;
-	gapR = w->t - v->t;
-
-	if( gapL + gapR > 0 ) {
-		if( gapL < gapR ) {
-			return (v->s - u->s) + (u->s - w->s) * (gapL / (gapL + gapR));
-		} else {
-			return (v->s - w->s) + (w->s - u->s) * (gapR / (gapL + gapR));
-		}
-	}
-	/* vertical line */
-	return 0;
-}
-
-TESSreal testransSign( TESSvertex *u, TESSvertex *v, TESSvertex *w )
-{
-	/* Returns a number whose sign matches TransEval(u,v,w) but which
-	* is cheaper to evaluate.  Returns > 0, == 0 , or < 0
-	* as v is above, on, or below the edge uw.
-	*/
-	TESSreal gapL, gapR;
-
-	assert( TransLeq( u, v ) && TransLeq( v, w ));
-
-	gapL = v->t - u->t;
-	gapR = w->t - v->t;
-
-	if( gapL + gapR > 0 ) {
-		return (v->s - w->s) * gapL + (v->s - u->s) * gapR;
-	}
-	/* vertical line */
-	return 0;
-}
-
-
-int tesvertCCW( TESSvertex *u, TESSvertex *v, TESSvertex *w )
-{
-	/* For almost-degenerate situations, the results are not reliable.
-	* Unless the floating-point arithmetic can be performed without
-	* rounding errors, *any* implementation will give incorrect results
-	* on some degenerate inputs, so the client must have some way to
-	* handle this situation.
-	*/
-	return (u->s*(v->t - w->t) + v->s*(w->t - u->t) + w->s*(u->t - v->t)) >= 0;
-}
-
 /* Given parameters a,x,b,y returns the value (b*x+a*y)/(a+b),
 * or (x+y)/2 if a==b==0.  It requires that a,b >= 0, and enforces
 * this in the rare case that one argument is slightly negative.
@@ -206,7 +82,7 @@ void tesedgeIntersect( TESSvertex *o1, TESSvertex *d1,
 					  * bounding rectangles defined by each edge.
 					  */
 {
-	TESSreal z1, z2;
+	double z1, z2;
 
 	/* This is certainly not the most efficient way to find the intersection
 	* of two line segments, but it is very numerically stable.
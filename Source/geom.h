@@ -32,8 +32,26 @@
 #ifndef GEOM_H
 #define GEOM_H
 
+#include <assert.h>
 #include "mesh.h"
 
+/* The predicates below are defined in this header so that the compiler can
+* inline them into the sweep and triangulation loops.
+*
+* EdgeEval, EdgeSign and their transposed versions compute in double
+* precision even when TESSreal is float.  With float intermediates a vertex
+* lying on (or next to) an edge can be classified on the wrong side of it
+* once nearby intersections have been computed, and the sweep then assigns
+* wrong winding numbers to whole regions.
+*/
+#if defined(_MSC_VER)
+#define TESS_INLINE static __inline
+#elif defined(__GNUC__)
+#define TESS_INLINE static __inline__
+#else
+#define TESS_INLINE static inline
+#endif
+
 #ifdef NO_BRANCH_CONDITIONS
 /* MIPS architecture has special instructions to evaluate boolean
 * conditions -- more efficient than branching, IF you can get the
@@ -66,13 +84,131 @@
 
 #define VertCCW(u,v,w) tesvertCCW(u,v,w)
 
-int tesvertLeq( TESSvertex *u, TESSvertex *v );
-TESSreal	tesedgeEval( TESSvertex *u, TESSvertex *v, TESSvertex *w );
-TESSreal	tesedgeSign( TESSvertex *u, TESSvertex *v, TESSvertex *w );
-TESSreal	testransEval( TESSvertex *u, TESSvertex *v, TESSvertex *w );
-TESSreal	testransSign( TESSvertex *u, TESSvertex *v, TESSvertex *w );
-int tesvertCCW( TESSvertex *u, TESSvertex *v, TESSvertex *w );
 void tesedgeIntersect( TESSvertex *o1, TESSvertex *d1, TESSvertex *o2, TESSvertex *d2, TESSvertex *v );
 int tesedgeIsLocallyDelaunay( TESShalfEdge *e );
 
+TESS_INLINE int tesvertLeq( TESSvertex *u, TESSvertex *v )
+{
+	/* Returns TRUE if u is lexicographically <= v. */
+
+	return VertLeq( u, v );
+}
+
+TESS_INLINE double tesedgeEval( TESSvertex *u, TESSvertex *v, TESSvertex *w )
+{
+	/* Given three vertices u,v,w such that VertLeq(u,v) && VertLeq(v,w),
+	* evaluates the t-coord of the edge uw at the s-coord of the vertex v.
+	* Returns v->t - (uw)(v->s), ie. the signed distance from uw to v.
+	* If uw is vertical (and thus passes thru v), the result is zero.
+	*
+	* The calculation is extremely accurate and stable, even when v
+	* is very close to u or w.  In particular if we set v->t = 0 and
+	* let r be the negated result (this evaluates (uw)(v->s)), then
+	* r is guaranteed to satisfy MIN(u->t,w->t) <= r <= MAX(u->t,w->t).
+	*/
+	double gapL, gapR;
+
+	assert( VertLeq( u, v ) && VertLeq( v, w ));
+
+	gapL = (double)v->s - u->s;
+	gapR = (double)w->s - v->s;
+
+	if( gapL + gapR > 0 ) {
+		if( gapL < gapR ) {
+			return ((double)v->t - u->t) + ((double)u->t - w->t) * (gapL / (gapL + gapR));
+		} else {
+			return ((double)v->t - w->t) + ((double)w->t - u->t) * (gapR / (gapL + gapR));
+		}
+	}
+	/* vertical line */
+	return 0;
+}
+
+TESS_INLINE double tesedgeSign( TESSvertex *u, TESSvertex *v, TESSvertex *w )
+{
+	/* Returns a number whose sign matches EdgeEval(u,v,w) but which
+	* is cheaper to evaluate.  Returns > 0, == 0 , or < 0
+	* as v is above, on, or below the edge uw.
+	*/
+	double gapL, gapR;
+
+	assert( VertLeq( u, v ) && VertLeq( v, w ));
+
+	gapL = (double)v->s - u->s;
+	gapR = (double)w->s - v->s;
+
+	if( gapL + gapR > 0 ) {
+		return ((double)v->t - w->t) * gapL + ((double)v->t - u->t) * gapR;
+	}
+	/* vertical line */
+	return 0;
+}
+
+
+/***********************************************************************
+* Define versions of EdgeSign, EdgeEval with s and t transposed.
+*/
+
+TESS_INLINE double testransEval( TESSvertex *u, TESSvertex *v, TESSvertex *w )
+{
+	/* Given three vertices u,v,w such that TransLeq(u,v) && TransLeq(v,w),
+	* evaluates the t-coord of the edge uw at the s-coord of the vertex v.
+	* Returns v->s - (uw)(v->t), ie. the signed distance from uw to v.
+	* If uw is vertical (and thus passes thru v), the result is zero.
+	*
+	* The calculation is extremely accurate and stable, even when v
+	* is very close to u or w.  In particular if we set v->s = 0 and
+	* let r be the negated result (this evaluates (uw)(v->t)), then
+	* r is guaranteed to satisfy MIN(u->s,w->s) <= r <= MAX(u->s,w->s).
+	*/
+	double gapL, gapR;
+
+	assert( TransLeq( u, v ) && TransLeq( v, w ));
+
+	gapL = (double)v->t - u->t;
+	gapR = (double)w->t - v->t;
+
+	if( gapL + gapR > 0 ) {
+		if( gapL < gapR ) {
+			return ((double)v->s - u->s) + ((double)u->s - w->s) * (gapL / (gapL + gapR));
+		} else {
+			return ((double)v->s - w->s) + ((double)w->s - u->s) * (gapR / (gapL + gapR));
+		}
+	}
+	/* vertical line */
+	return 0;
+}
+
+TESS_INLINE double testransSign( TESSvertex *u, TESSvertex *v, TESSvertex *w )
+{
+	/* Returns a number whose sign matches TransEval(u,v,w) but which
+	* is cheaper to evaluate.  Returns > 0, == 0 , or < 0
+	* as v is above, on, or below the edge uw.
+	*/
+	double gapL, gapR;
+
+	assert( TransLeq( u, v ) && TransLeq( v, w ));
+
+	gapL = (double)v->t - u->t;
+	gapR = (double)w->t - v->t;
+
+	if( gapL + gapR > 0 ) {
+		return ((double)v->s - w->s) * gapL + ((double)v->s - u->s) * gapR;
+	}
+	/* vertical line */
+	return 0;
+}
+
+
+TESS_INLINE int tesvertCCW( TESSvertex *u, TESSvertex *v, TESSvertex *w )
+{
+	/* For almost-degenerate situations, the results are not reliable.
+	* Unless the floating-point arithmetic can be performed without
+	* rounding errors, *any* implementation will give incorrect results
+	* on some degenerate inputs, so the client must have some way to
+	* handle this situation.
+	*/
+	return (u->s*(v->t - w->t) + v->s*(w->t - u->t) + w->s*(u->t - v->t)) >= 0;
+}
+
 #endif
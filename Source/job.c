@@ -0,0 +1,191 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <math.h>
+#include "tess.h"
+#include "scheduler.h"
+
+/* Asynchronous jobs.  A job is a task of its own group on the scheduler,
+* so tessIsJobDone() just checks whether the group is pending, and
+* tessWaitJob() helps the workers like any other wait.  The tesselation
+* itself goes through tessTesselateBatch(), so a large job is split into
+* parts which the other workers can steal.
+*
+* The latencies of the completed jobs are counted in a histogram of the
+* scheduler with atomic increments, and the percentiles are read from it
+* on demand, so the bookkeeping needs no locks and no memory per job.
+*/
+
+struct TESSjob {
+	TESSalloc alloc;
+	TESSscheduler *sched;
+	TESStesselator *tess;
+	int windingRule;
+	int elementType;
+	int polySize;
+	int vertexSize;
+	TESSreal normal[3];
+	int hasNormal;
+	TESSjobCallback *callback;
+	void *userData;
+	int result;
+	double submitTime;
+	TessTaskGroup group;
+	TessTask task;
+};
+
+static int LatencyBucket( double seconds )
+{
+	double us = seconds * 1e6;
+	int i;
+	if( us < 1.0 )
+		return 0;
+	i = (int)(2.0 * log( us ) / log( 2.0 ));
+	return i < TESS_LATENCY_BUCKETS ? i : TESS_LATENCY_BUCKETS-1;
+}
+
+/* Upper bound of the latency bucket in seconds. */
+static double LatencyBucketLimit( int i )
+{
+	return pow( 2.0, (i+1) * 0.5 ) * 1e-6;
+}
+
+static void RunJob( void *data )
+{
+	TESSjob *job = (TESSjob*)data;
+	TESSscheduler *sched = job->sched;
+
+	job->result = tessTesselateBatch( sched, &job->tess, 1, job->windingRule, job->elementType,
+									  job->polySize, job->vertexSize,
+									  job->hasNormal ? job->normal : NULL );
+
+	if( sched != NULL ) {
+		tessAtomicAdd( &sched->latency[LatencyBucket( tessTimeSeconds() - job->submitTime )], 1 );
+		tessAtomicAdd( &sched->jobsCompleted, 1 );
+	}
+
+	if( job->callback != NULL )
+		job->callback( job, job->result, job->userData );
+}
+
+TESSjob* tessSubmitJob( TESSscheduler* sched, TESStesselator* tess,
+						int windingRule, int elementType, int polySize, int vertexSize,
+						const TESSreal* normal, TESSjobCallback* callback, void* userData )
+{
+	/* Not tess->alloc, the job may outlive the tesselator. */
+	TESSalloc *alloc = sched != NULL ? &sched->alloc : &tess->userAlloc;
+	TESSjob *job;
+
+	job = (TESSjob*)alloc->memalloc( alloc->userData, sizeof(TESSjob) );
+	if( job == NULL )
+		return 0;
+	job->alloc = *alloc;
+	job->sched = sched;
+	job->tess = tess;
+	job->windingRule = windingRule;
+	job->elementType = elementType;
+	job->polySize = polySize;
+	job->vertexSize = vertexSize;
+	job->hasNormal = normal != NULL;
+	if( normal != NULL ) {
+		job->normal[0] = normal[0];
+		job->normal[1] = normal[1];
+		job->normal[2] = normal[2];
+	}
+	job->callback = callback;
+	job->userData = userData;
+	job->result = 0;
+
+	if( sched != NULL ) {
+		job->submitTime = tessTimeSeconds();
+		tessAtomicAdd( &sched->jobsSubmitted, 1 );
+	}
+	tessTaskGroupInit( &job->group );
+	tessSchedulerSpawn( sched, &job->group, &job->task, RunJob, job );
+
+	return job;
+}
+
+int tessIsJobDone( TESSjob* job )
+{
+	return tessAtomicLoad( &job->group.pending ) == 0;
+}
+
+int tessWaitJob( TESSjob* job )
+{
+	tessSchedulerWait( job->sched, &job->group );
+	return job->result;
+}
+
+void tessDeleteJob( TESSjob* job )
+{
+	TESSalloc alloc;
+
+	if( job == NULL ) return;
+
+	tessSchedulerWait( job->sched, &job->group );
+	alloc = job->alloc;
+	alloc.memfree( alloc.userData, job );
+}
+
+void tessGetSchedulerStats( TESSscheduler* sched, TESSschedulerStats* stats )
+{
+	long counts[TESS_LATENCY_BUCKETS];
+	long total = 0, sum = 0;
+	long submitted, completed;
+	int i;
+
+	stats->threadCount = sched->threadCount;
+	stats->queueDepth = (int)tessAtomicLoad( &sched->queued );
+	/* Read the completed count first so the difference is never negative. */
+	completed = tessAtomicLoad( &sched->jobsCompleted );
+	submitted = tessAtomicLoad( &sched->jobsSubmitted );
+	stats->jobsInFlight = (int)(submitted - completed);
+	stats->jobsCompleted = (int)completed;
+
+	for( i = 0; i < TESS_LATENCY_BUCKETS; ++i ) {
+		counts[i] = tessAtomicLoad( &sched->latency[i] );
+		total += counts[i];
+	}
+
+	stats->latency50 = stats->latency90 = stats->latency99 = 0;
+	if( total == 0 )
+		return;
+	for( i = 0; i < TESS_LATENCY_BUCKETS; ++i ) {
+		sum += counts[i];
+		if( stats->latency50 == 0 && sum * 100 >= total * 50 )
+			stats->latency50 = LatencyBucketLimit( i );
+		if( stats->latency90 == 0 && sum * 100 >= total * 90 )
+			stats->latency90 = LatencyBucketLimit( i );
+		if( stats->latency99 == 0 && sum * 100 >= total * 99 ) {
+			stats->latency99 = LatencyBucketLimit( i );
+			break;
+		}
+	}
+}
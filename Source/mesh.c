@@ -55,8 +55,13 @@ static TESShalfEdge *MakeEdge( TESSmesh* mesh, TESShalfEdge *eNext )
 	TESShalfEdge *e;
 	TESShalfEdge *eSym;
 	TESShalfEdge *ePrev;
-	EdgePair *pair = (EdgePair *)bucketAlloc( mesh->edgeBucket );
+	EdgePair *pair;
+
+	/* Check for room in the log first, so that a full log leaks nothing */
+	if( mesh->log != NULL && mesh->log->edgeCount >= mesh->log->maxCount ) return NULL;
+	pair = (EdgePair *)bucketAlloc( mesh->edgeBucket );
 	if (pair == NULL) return NULL;
+	mesh->edgeCount++;
 
 	e = &pair->e;
 	eSym = &pair->eSym;
@@ -64,14 +69,24 @@ static TESShalfEdge *MakeEdge( TESSmesh* mesh, TESShalfEdge *eNext )
 	/* Make sure eNext points to the first edge of the edge pair */
 	if( eNext->Sym < eNext ) { eNext = eNext->Sym; }
 
-	/* Insert in circular doubly-linked list before eNext.
-	* Note that the prev pointer is stored in Sym->next.
-	*/
-	ePrev = eNext->Sym->next;
-	eSym->next = ePrev;
-	ePrev->Sym->next = e;
-	e->next = eNext;
-	eNext->Sym->next = eSym;
+	if( mesh->log != NULL ) {
+		/* Inserted later by tessMeshLinkLog() */
+		TESSmeshLog *log = mesh->log;
+		log->edges[log->edgeCount*2+0] = e;
+		log->edges[log->edgeCount*2+1] = eNext;
+		log->edgeCount++;
+		e->next = NULL;
+		eSym->next = NULL;
+	} else {
+		/* Insert in circular doubly-linked list before eNext.
+		* Note that the prev pointer is stored in Sym->next.
+		*/
+		ePrev = eNext->Sym->next;
+		eSym->next = ePrev;
+		ePrev->Sym->next = e;
+		e->next = eNext;
+		eNext->Sym->next = eSym;
+	}
 
 	e->Sym = eSym;
 	e->Onext = e;
@@ -111,13 +126,13 @@ static void Splice( TESShalfEdge *a, TESShalfEdge *b )
 	b->Onext = aOnext;
 }
 
-/* MakeVertex( newVertex, eOrig, vNext ) attaches a new vertex and makes it the
+/* MakeVertex( mesh, newVertex, eOrig, vNext ) attaches a new vertex and makes it the
 * origin of all edges in the vertex loop to which eOrig belongs. "vNext" gives
 * a place to insert the new vertex in the global vertex list.  We insert
 * the new vertex *before* vNext so that algorithms which walk the vertex
 * list will not see the newly created vertices.
 */
-static void MakeVertex( TESSvertex *newVertex, 
+static void MakeVertex( TESSmesh *mesh, TESSvertex *newVertex,
 					   TESShalfEdge *eOrig, TESSvertex *vNext )
 {
 	TESShalfEdge *e;
@@ -132,6 +147,7 @@ static void MakeVertex( TESSvertex *newVertex,
 	vPrev->next = vNew;
 	vNew->next = vNext;
 	vNext->prev = vNew;
+	mesh->vertexCount++;
 
 	vNew->anEdge = eOrig;
 	/* leave coords, s, t undefined */
@@ -144,15 +160,16 @@ static void MakeVertex( TESSvertex *newVertex,
 	} while( e != eOrig );
 }
 
-/* MakeFace( newFace, eOrig, fNext ) attaches a new face and makes it the left
+/* MakeFace( mesh, newFace, eOrig, fNext ) attaches a new face and makes it the left
 * face of all edges in the face loop to which eOrig belongs.  "fNext" gives
 * a place to insert the new face in the global face list.  We insert
 * the new face *before* fNext so that algorithms which walk the face
 * list will not see the newly created faces.
 */
-static void MakeFace( TESSface *newFace, TESShalfEdge *eOrig, TESSface *fNext )
+static void InitFace( TESSmesh *mesh, TESSface *newFace, TESShalfEdge *eOrig, TESSface *fNext );
+
+static void MakeFace( TESSmesh *mesh, TESSface *newFace, TESShalfEdge *eOrig, TESSface *fNext )
 {
-	TESShalfEdge *e;
 	TESSface *fPrev;
 	TESSface *fNew = newFace;
 
@@ -165,6 +182,17 @@ static void MakeFace( TESSface *newFace, TESShalfEdge *eOrig, TESSface *fNext )
 	fNew->next = fNext;
 	fNext->prev = fNew;
 
+	InitFace( mesh, fNew, eOrig, fNext );
+}
+
+/* InitFace( mesh, newFace, eOrig, fNext ) is MakeFace() without the
+* insertion into the global face list.  The face is counted in "mesh".
+*/
+static void InitFace( TESSmesh *mesh, TESSface *newFace, TESShalfEdge *eOrig, TESSface *fNext )
+{
+	TESShalfEdge *e;
+	TESSface *fNew = newFace;
+
 	fNew->anEdge = eOrig;
 	fNew->trail = NULL;
 	fNew->marked = FALSE;
@@ -173,6 +201,12 @@ static void MakeFace( TESSface *newFace, TESShalfEdge *eOrig, TESSface *fNext )
 	* convenience for the common case where a face has been split in two.
 	*/
 	fNew->inside = fNext->inside;
+	/* Likewise a split face stays in the region it was tagged with (see
+	* TESS_GROUPED_OUTPUT).
+	*/
+	fNew->n = fNext->n;
+	mesh->faceCount++;
+	if( fNew->inside ) mesh->insideCount++;
 
 	/* fix other edges on this face loop */
 	e = eOrig;
@@ -197,6 +231,7 @@ static void KillEdge( TESSmesh *mesh, TESShalfEdge *eDel )
 	ePrev = eDel->Sym->next;
 	eNext->Sym->next = ePrev;
 	ePrev->Sym->next = eNext;
+	mesh->edgeCount--;
 
 	bucketFree( mesh->edgeBucket, eDel );
 }
@@ -222,6 +257,7 @@ static void KillVertex( TESSmesh *mesh, TESSvertex *vDel, TESSvertex *newOrg )
 	vNext = vDel->next;
 	vNext->prev = vPrev;
 	vPrev->next = vNext;
+	mesh->vertexCount--;
 
 	bucketFree( mesh->vertexBucket, vDel );
 }
@@ -246,6 +282,8 @@ static void KillFace( TESSmesh *mesh, TESSface *fDel, TESSface *newLface )
 	fNext = fDel->next;
 	fNext->prev = fPrev;
 	fPrev->next = fNext;
+	mesh->faceCount--;
+	if( fDel->inside ) mesh->insideCount--;
 
 	bucketFree( mesh->faceBucket, fDel );
 }
@@ -274,9 +312,9 @@ TESShalfEdge *tessMeshMakeEdge( TESSmesh *mesh )
 	e = MakeEdge( mesh, &mesh->eHead );
 	if (e == NULL) return NULL;
 
-	MakeVertex( newVertex1, e, &mesh->vHead );
-	MakeVertex( newVertex2, e->Sym, &mesh->vHead );
-	MakeFace( newFace, e, &mesh->fHead );
+	MakeVertex( mesh, newVertex1, e, &mesh->vHead );
+	MakeVertex( mesh, newVertex2, e->Sym, &mesh->vHead );
+	MakeFace( mesh, newFace, e, &mesh->fHead );
 	return e;
 }
 
@@ -332,7 +370,7 @@ int tessMeshSplice( TESSmesh* mesh, TESShalfEdge *eOrg, TESShalfEdge *eDst )
 		/* We split one vertex into two -- the new vertex is eDst->Org.
 		* Make sure the old vertex points to a valid half-edge.
 		*/
-		MakeVertex( newVertex, eDst, eOrg->Org );
+		MakeVertex( mesh, newVertex, eDst, eOrg->Org );
 		eOrg->Org->anEdge = eOrg;
 	}
 	if( ! joiningLoops ) {
@@ -342,7 +380,7 @@ int tessMeshSplice( TESSmesh* mesh, TESShalfEdge *eOrg, TESShalfEdge *eDst )
 		/* We split one loop into two -- the new loop is eDst->Lface.
 		* Make sure the old face points to a valid half-edge.
 		*/
-		MakeFace( newFace, eDst, eOrg->Lface );
+		MakeFace( mesh, newFace, eDst, eOrg->Lface );
 		eOrg->Lface->anEdge = eOrg;
 	}
 
@@ -387,7 +425,7 @@ int tessMeshDelete( TESSmesh *mesh, TESShalfEdge *eDel )
 			if (newFace == NULL) return 0; 
 
 			/* We are splitting one loop into two -- create a new loop for eDel. */
-			MakeFace( newFace, eDel, eDel->Lface );
+			MakeFace( mesh, newFace, eDel, eDel->Lface );
 		}
 	}
 
@@ -439,7 +477,7 @@ TESShalfEdge *tessMeshAddEdgeVertex( TESSmesh *mesh, TESShalfEdge *eOrg )
 		TESSvertex *newVertex= (TESSvertex*)bucketAlloc( mesh->vertexBucket );
 		if (newVertex == NULL) return NULL;
 
-		MakeVertex( newVertex, eNewSym, eNew->Org );
+		MakeVertex( mesh, newVertex, eNewSym, eNew->Org );
 	}
 	eNew->Lface = eNewSym->Lface = eOrg->Lface;
 
@@ -488,13 +526,18 @@ TESShalfEdge *tessMeshConnect( TESSmesh *mesh, TESShalfEdge *eOrg, TESShalfEdge
 {
 	TESShalfEdge *eNewSym;
 	int joiningLoops = FALSE;  
-	TESShalfEdge *eNew = MakeEdge( mesh, eOrg );
+	TESShalfEdge *eNew;
+
+	/* A logged connect splits a face, see below */
+	if( mesh->log != NULL && mesh->log->faceCount >= mesh->log->maxCount ) return NULL;
+	eNew = MakeEdge( mesh, eOrg );
 	if (eNew == NULL) return NULL;
 
 	eNewSym = eNew->Sym;
 
 	if( eDst->Lface != eOrg->Lface ) {
 		/* We are connecting two disjoint loops -- destroy eDst->Lface */
+		assert( mesh->log == NULL );
 		joiningLoops = TRUE;
 		KillFace( mesh, eDst->Lface, eOrg->Lface );
 	}
@@ -516,7 +559,15 @@ TESShalfEdge *tessMeshConnect( TESSmesh *mesh, TESShalfEdge *eOrg, TESShalfEdge
 		if (newFace == NULL) return NULL;
 
 		/* We split one loop into two -- the new loop is eNew->Lface */
-		MakeFace( newFace, eNew, eOrg->Lface );
+		if( mesh->log != NULL ) {
+			/* Inserted later by tessMeshLinkLog() */
+			TESSmeshLog *log = mesh->log;
+			log->faces[log->faceCount*2+0] = newFace;
+			log->faces[log->faceCount*2+1] = eOrg->Lface;
+			log->faceCount++;
+			InitFace( mesh, newFace, eNew, eOrg->Lface );
+		} else
+			MakeFace( mesh, newFace, eNew, eOrg->Lface );
 	}
 	return eNew;
 }
@@ -571,6 +622,8 @@ void tessMeshZapFace( TESSmesh *mesh, TESSface *fZap )
 	fNext = fZap->next;
 	fNext->prev = fPrev;
 	fPrev->next = fNext;
+	mesh->faceCount--;
+	if( fZap->inside ) mesh->insideCount--;
 
 	bucketFree( mesh->faceBucket, fZap );
 }
@@ -579,12 +632,13 @@ void tessMeshZapFace( TESSmesh *mesh, TESSface *fZap )
 /* tessMeshNewMesh() creates a new mesh with no edges, no vertices,
 * and no loops (what we usually call a "face").
 */
-TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
+TESSmesh *tessMeshNewMesh( TESSalloc* alloc, int vertexCount )
 {
 	TESSvertex *v;
 	TESSface *f;
 	TESShalfEdge *e;
 	TESShalfEdge *eSym;
+	int edgeBucketSize, vertexBucketSize, faceBucketSize;
 	TESSmesh *mesh = (TESSmesh *)alloc->memalloc( alloc->userData, sizeof( TESSmesh ));
 	if (mesh == NULL) {
 		return NULL;
@@ -605,9 +659,31 @@ TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
 	if (alloc->meshFaceBucketSize > 4096)
 		alloc->meshFaceBucketSize = 4096;
 
-	mesh->edgeBucket = createBucketAlloc( alloc, "Mesh Edges", sizeof(EdgePair), alloc->meshEdgeBucketSize );
-	mesh->vertexBucket = createBucketAlloc( alloc, "Mesh Vertices", sizeof(TESSvertex), alloc->meshVertexBucketSize );
-	mesh->faceBucket = createBucketAlloc( alloc, "Mesh Faces", sizeof(TESSface), alloc->meshFaceBucketSize );
+	if (alloc->adaptiveBuckets) {
+		/* The contours have as many edges as vertices.  Their triangulation
+		* about doubles the edges and makes a face per vertex, which the
+		* growing buckets take care of. */
+		if (vertexCount < 0)
+			vertexCount = 0;
+		edgeBucketSize = vertexCount;
+		vertexBucketSize = vertexCount;
+		faceBucketSize = vertexCount / 2;
+	} else {
+		edgeBucketSize = alloc->meshEdgeBucketSize;
+		vertexBucketSize = alloc->meshVertexBucketSize;
+		faceBucketSize = alloc->meshFaceBucketSize;
+	}
+
+	mesh->edgeBucket = createBucketAlloc( alloc, "Mesh Edges", sizeof(EdgePair), edgeBucketSize );
+	mesh->vertexBucket = createBucketAlloc( alloc, "Mesh Vertices", sizeof(TESSvertex), vertexBucketSize );
+	mesh->faceBucket = createBucketAlloc( alloc, "Mesh Faces", sizeof(TESSface), faceBucketSize );
+	if (mesh->edgeBucket == NULL || mesh->vertexBucket == NULL || mesh->faceBucket == NULL) {
+		deleteBucketAlloc( mesh->edgeBucket );
+		deleteBucketAlloc( mesh->vertexBucket );
+		deleteBucketAlloc( mesh->faceBucket );
+		alloc->memfree( alloc->userData, mesh );
+		return NULL;
+	}
 
 	v = &mesh->vHead;
 	f = &mesh->fHead;
@@ -622,6 +698,13 @@ TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
 	f->trail = NULL;
 	f->marked = FALSE;
 	f->inside = FALSE;
+	f->n = TESS_UNDEF;
+
+	mesh->log = NULL;
+	mesh->vertexCount = 0;
+	mesh->faceCount = 0;
+	mesh->edgeCount = 0;
+	mesh->insideCount = 0;
 
 	e->next = e;
 	e->Sym = eSym;
@@ -645,6 +728,47 @@ TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
 }
 
 
+/* tessMeshLinkLog( log ) inserts the logged edges and faces into
+* the global lists.  Each one is inserted before the structure which was
+* its place when it was created, in the order of creation, so the lists end
+* up as if the operations had not been deferred at all.
+*/
+void tessMeshLinkLog( TESSmeshLog *log )
+{
+	TESShalfEdge *e, *eNext, *ePrev;
+	TESSface *f, *fNext, *fPrev;
+	int i;
+
+	for( i = 0; i < log->edgeCount; ++i ) {
+		e = log->edges[i*2+0];
+		eNext = log->edges[i*2+1];
+		ePrev = eNext->Sym->next;
+		e->Sym->next = ePrev;
+		ePrev->Sym->next = e;
+		e->next = eNext;
+		eNext->Sym->next = e->Sym;
+	}
+	for( i = 0; i < log->faceCount; ++i ) {
+		f = log->faces[i*2+0];
+		fNext = log->faces[i*2+1];
+		fPrev = fNext->prev;
+		f->prev = fPrev;
+		fPrev->next = f;
+		f->next = fNext;
+		fNext->prev = f;
+	}
+}
+
+/* tessMeshSetInside( mesh, f, inside ) sets the "inside" flag of f
+* and keeps the count of inside faces.
+*/
+void tessMeshSetInside( TESSmesh *mesh, TESSface *f, int inside )
+{
+	inside = inside ? TRUE : FALSE;
+	mesh->insideCount += inside - f->inside;
+	f->inside = (char)inside;
+}
+
 /* tessMeshUnion( mesh1, mesh2 ) forms the union of all structures in
 * both meshes, and returns the new mesh (the old meshes are destroyed).
 */
@@ -679,6 +803,16 @@ TESSmesh *tessMeshUnion( TESSalloc* alloc, TESSmesh *mesh1, TESSmesh *mesh2 )
 		e1->Sym->next = e2->Sym->next;
 	}
 
+	mesh1->vertexCount += mesh2->vertexCount;
+	mesh1->faceCount += mesh2->faceCount;
+	mesh1->edgeCount += mesh2->edgeCount;
+	mesh1->insideCount += mesh2->insideCount;
+
+	/* The structures of mesh2 are freed through the buckets of mesh1 from now on. */
+	bucketAllocMerge( mesh1->edgeBucket, mesh2->edgeBucket );
+	bucketAllocMerge( mesh1->vertexBucket, mesh2->vertexBucket );
+	bucketAllocMerge( mesh1->faceBucket, mesh2->faceBucket );
+
 	alloc->memfree( alloc->userData, mesh2 );
 	return mesh1;
 }
@@ -869,9 +1003,12 @@ void tessMeshCheckMesh( TESSmesh *mesh )
 	TESSface *f, *fPrev;
 	TESSvertex *v, *vPrev;
 	TESShalfEdge *e, *ePrev;
+	int vertexCount = 0, faceCount = 0, edgeCount = 0, insideCount = 0;
 
 	for( fPrev = fHead ; (f = fPrev->next) != fHead; fPrev = f) {
 		assert( f->prev == fPrev );
+		faceCount++;
+		if( f->inside ) insideCount++;
 		e = f->anEdge;
 		do {
 			assert( e->Sym != e );
@@ -886,6 +1023,7 @@ void tessMeshCheckMesh( TESSmesh *mesh )
 
 	for( vPrev = vHead ; (v = vPrev->next) != vHead; vPrev = v) {
 		assert( v->prev == vPrev );
+		vertexCount++;
 		e = v->anEdge;
 		do {
 			assert( e->Sym != e );
@@ -900,6 +1038,7 @@ void tessMeshCheckMesh( TESSmesh *mesh )
 
 	for( ePrev = eHead ; (e = ePrev->next) != eHead; ePrev = e) {
 		assert( e->Sym->next == ePrev->Sym );
+		edgeCount++;
 		assert( e->Sym != e );
 		assert( e->Sym->Sym == e );
 		assert( e->Org != NULL );
@@ -912,6 +1051,11 @@ void tessMeshCheckMesh( TESSmesh *mesh )
 		&& e->Sym->Sym == e
 		&& e->Org == NULL && e->Dst == NULL
 		&& e->Lface == NULL && e->Rface == NULL );
+
+	assert( vertexCount == mesh->vertexCount );
+	assert( faceCount == mesh->faceCount );
+	assert( edgeCount == mesh->edgeCount );
+	assert( insideCount == mesh->insideCount );
 }
 
 #endif
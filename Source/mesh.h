@@ -39,6 +39,7 @@ typedef struct TESSvertex TESSvertex;
 typedef struct TESSface TESSface;
 typedef struct TESShalfEdge TESShalfEdge;
 typedef struct ActiveRegion ActiveRegion;
+typedef struct TESSmeshLog TESSmeshLog;
 
 /* The mesh structure is similar in spirit, notation, and operations
 * to the "quad-edge" structure (see L. Guibas and J. Stolfi, Primitives
@@ -114,7 +115,7 @@ struct TESSvertex {
 	/* Internal data (keep hidden) */
 	TESSreal coords[3];  /* vertex location in 3D */
 	TESSreal s, t;       /* projection onto the sweep plane */
-	int pqHandle;   /* to allow deletion from priority queue */
+	int pqHandle;   /* position in the priority queue (see priorityq.h) */
 	TESSindex n;			/* to allow identify unique vertices */
 	TESSindex idx;			/* to allow map result to original verts */
 };
@@ -165,6 +166,31 @@ struct TESSmesh {
 	struct BucketAlloc* edgeBucket;
 	struct BucketAlloc* vertexBucket;
 	struct BucketAlloc* faceBucket;
+
+	TESSmeshLog *log;	/* defers the list insertions, see TESSmeshLog */
+
+	/* Kept up to date by the mesh operations, so that the passes over the
+	* mesh can size their arrays without walking the lists first.
+	*/
+	int vertexCount;
+	int faceCount;
+	int edgeCount;		/* number of edges, ie. half-edge pairs */
+	int insideCount;	/* number of faces marked "inside" */
+};
+
+/* While a mesh has a log, the new edges and faces are not inserted into
+* the global lists, but recorded with the place where they would go.
+* This lets several threads split disjoint faces of one mesh at the same
+* time, each using a mesh of its own for the allocations, and
+* tessMeshLinkLog() then replays the insertions in a fixed order.
+* Only tessMeshConnect() which splits a face may be used with a log.
+*/
+struct TESSmeshLog {
+	TESShalfEdge **edges;	/* new edge and the edge it goes before, in pairs */
+	TESSface **faces;		/* new face and the face it goes before, in pairs */
+	int edgeCount;
+	int faceCount;
+	int maxCount;			/* room for pairs in both arrays */
 };
 
 /* The mesh operations below have three motivations: completeness,
@@ -226,8 +252,10 @@ struct TESSmesh {
 *
 * ************************ Other Operations *****************************
 *
-* tessMeshNewMesh() creates a new mesh with no edges, no vertices,
-* and no loops (what we usually call a "face").
+* tessMeshNewMesh( alloc, vertexCount ) creates a new mesh with no edges,
+* no vertices, and no loops (what we usually call a "face").  If
+* alloc->adaptiveBuckets is set, "vertexCount" (the expected number of
+* vertices, or 0 if not known) sizes the first buckets.
 *
 * tessMeshUnion( mesh1, mesh2 ) forms the union of all structures in
 * both meshes, and returns the new mesh (the old meshes are destroyed).
@@ -241,6 +269,14 @@ struct TESSmesh {
 * An entire mesh can be deleted by zapping its faces, one at a time,
 * in any order.  Zapped faces cannot be used in further mesh operations!
 *
+* tessMeshSetInside( mesh, f, inside ) sets the "inside" flag of face f.
+* The flag must not be set directly, since the mesh counts inside faces.
+*
+* tessMeshLinkLog( log ) inserts the edges and faces recorded in "log"
+* into the global lists, in the order they were created.
+* The logged structures were allocated by another mesh, which must be
+* joined with tessMeshUnion() afterwards.
+*
 * tessMeshCheckMesh( mesh ) checks a mesh for self-consistency.
 */
 
@@ -252,11 +288,13 @@ TESShalfEdge *tessMeshAddEdgeVertex( TESSmesh *mesh, TESShalfEdge *eOrg );
 TESShalfEdge *tessMeshSplitEdge( TESSmesh *mesh, TESShalfEdge *eOrg );
 TESShalfEdge *tessMeshConnect( TESSmesh *mesh, TESShalfEdge *eOrg, TESShalfEdge *eDst );
 
-TESSmesh *tessMeshNewMesh( TESSalloc* alloc );
+TESSmesh *tessMeshNewMesh( TESSalloc* alloc, int vertexCount );
 TESSmesh *tessMeshUnion( TESSalloc* alloc, TESSmesh *mesh1, TESSmesh *mesh2 );
 int tessMeshMergeConvexFaces( TESSmesh *mesh, int maxVertsPerFace );
 void tessMeshDeleteMesh( TESSalloc* alloc, TESSmesh *mesh );
 void tessMeshZapFace( TESSmesh *mesh, TESSface *fZap );
+void tessMeshLinkLog( TESSmeshLog *log );
+void tessMeshSetInside( TESSmesh *mesh, TESSface *f, int inside );
 
 void tessMeshFlipEdge( TESSmesh *mesh, TESShalfEdge *edge );
 
@@ -0,0 +1,227 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <math.h>
+#include "tess.h"
+#include "capture.h"
+
+#define TESS_PI	3.14159265358979323846f
+
+/* Offsetting builds the raw offset contour of each input contour: every
+* edge is moved by the offset along its outward normal, and consecutive
+* edges are connected at the vertices.  Where the offset edges diverge
+* (convex corner for positive offset) the gap is closed with a join.
+* Where they overlap, the offset edges are connected through the original
+* vertex.  The resulting loops cancel out under TESS_WINDING_POSITIVE,
+* so the sweep in tessTesselate() cleans up the self-intersections.
+*/
+
+typedef struct OffsetState OffsetState;
+
+struct OffsetState {
+	TESStesselator *tess;
+	TESShalfEdge *e;	/* last edge of the contour being built */
+	TESSreal z;			/* z-coordinate of the current source vertex */
+	TESSindex idx;		/* index of the current source vertex */
+};
+
+static int EmitPoint( OffsetState *st, TESSreal x, TESSreal y )
+{
+	st->e = tessAddContourVertex( st->tess, st->e, x, y, st->z, st->idx );
+	return st->e != NULL;
+}
+
+static int EmitArc( OffsetState *st, const TESSreal *p, TESSreal nx, TESSreal ny,
+				   TESSreal angle, TESSreal offset, TESSreal tolerance )
+/*
+* Emits an arc around "p" starting at p + (nx,ny)*offset and sweeping
+* "angle" radians.  The number of segments is chosen so that the chord
+* error stays below "tolerance".
+*/
+{
+	TESSreal r = offset < 0 ? -offset : offset;
+	TESSreal da, c, s, x, y, tmp;
+	int i, n;
+
+	if( tolerance < r ) {
+		da = 2 * acosf( 1 - tolerance / r );
+	} else {
+		da = TESS_PI;
+	}
+	n = (int)ceilf( (angle < 0 ? -angle : angle) / da );
+	if( n < 1 ) n = 1;
+	if( n > 1024 ) n = 1024;
+
+	c = cosf( angle / n );
+	s = sinf( angle / n );
+	x = nx * offset;
+	y = ny * offset;
+	for( i = 0; i <= n; ++i ) {
+		if ( !EmitPoint( st, p[0] + x, p[1] + y ) ) return 0;
+		tmp = x*c - y*s;
+		y = x*s + y*c;
+		x = tmp;
+	}
+	return 1;
+}
+
+static int EmitJoin( OffsetState *st, const TESSreal *p,
+					const TESSreal *d0, const TESSreal *n0,
+					const TESSreal *d1, const TESSreal *n1, TESSreal angle,
+					TESSreal offset, int joinType, TESSreal miterLimit, TESSreal tolerance )
+/*
+* Closes the gap between the offset edges (p + n0*offset) and (p + n1*offset)
+* which turn by "angle" radians at the vertex "p".
+*/
+{
+	TESSreal r = offset < 0 ? -offset : offset;
+	TESSreal dot = n0[0]*n1[0] + n0[1]*n1[1];
+	TESSreal k;
+
+	if( joinType == TESS_JOIN_ROUND ) {
+		return EmitArc( st, p, n0[0], n0[1], angle, offset, tolerance );
+	}
+
+	if( joinType == TESS_JOIN_MITER && dot > -0.999f ) {
+		/* The miter length is offset / cos(angle/2). */
+		if( 2 <= miterLimit*miterLimit * (1 + dot) ) {
+			k = offset / (1 + dot);
+			return EmitPoint( st, p[0] + (n0[0] + n1[0]) * k, p[1] + (n0[1] + n1[1]) * k );
+		}
+	}
+
+	/* Square the corner at the offset distance from the vertex. */
+	k = r * tanf( (angle < 0 ? -angle : angle) / 4 );
+	if ( !EmitPoint( st, p[0] + n0[0]*offset + d0[0]*k, p[1] + n0[1]*offset + d0[1]*k ) ) return 0;
+	return EmitPoint( st, p[0] + n1[0]*offset - d1[0]*k, p[1] + n1[1]*offset - d1[1]*k );
+}
+
+#define Vertex(i)	((const TESSreal*)(src + (i) * stride))
+#define SamePoint(a,b)	((a)[0] == (b)[0] && (a)[1] == (b)[1])
+
+void tessAddOffsetContour( TESStesselator *tess, int size, const void* vertices,
+						   int stride, int numVertices, TESSreal offset, int joinType,
+						   TESSreal miterLimit, TESSreal arcTolerance )
+{
+	const unsigned char *src = (const unsigned char*)vertices;
+	const TESSreal *p, *prev, *next;
+	TESSreal d0[2], d1[2], n0[2], n1[2], len, cross, dot, angle;
+	TESSindex base;
+	OffsetState st;
+	int i, j, k;
+
+	if( offset == 0 ) {
+		tessAddContour( tess, size, vertices, stride, numVertices );
+		return;
+	}
+	if( tess->capture != NULL )
+		tessCaptureOffsetContour( tess, size, vertices, stride, numVertices,
+								  offset, joinType, miterLimit, arcTolerance );
+	if( numVertices <= 0 ) return;
+	if ( !tessBeginContour( tess, numVertices ) ) return;
+
+	if( miterLimit <= 0 )
+		miterLimit = 2;
+	if( arcTolerance <= 0 )
+		arcTolerance = (offset < 0 ? -offset : offset) * 0.01f;
+
+	base = tess->vertexIndexCounter;
+	tess->vertexIndexCounter += numVertices;
+
+	st.tess = tess;
+	st.e = NULL;
+
+	for( i = 0; i < numVertices; ++i ) {
+		p = Vertex(i);
+		st.z = size > 2 ? p[2] : 0;
+		st.idx = base + i;
+
+		/* Skip repeated vertices, the first one of the run is used. */
+		prev = Vertex( (i + numVertices - 1) % numVertices );
+		if( i > 0 && SamePoint( p, prev )) continue;
+		for( j = 1; j < numVertices; ++j ) {
+			prev = Vertex( (i + numVertices - j) % numVertices );
+			if( ! SamePoint( p, prev )) break;
+		}
+		if( j == numVertices ) {
+			/* All vertices are the same, offset the point itself. */
+			if( offset < 0 ) return;
+			if( joinType == TESS_JOIN_ROUND ) {
+				EmitArc( &st, p, 1, 0, 2*TESS_PI, offset, arcTolerance );
+			} else {
+				if ( !EmitPoint( &st, p[0] + offset, p[1] - offset )) return;
+				if ( !EmitPoint( &st, p[0] + offset, p[1] + offset )) return;
+				if ( !EmitPoint( &st, p[0] - offset, p[1] + offset )) return;
+				EmitPoint( &st, p[0] - offset, p[1] - offset );
+			}
+			return;
+		}
+		for( k = 1; k < numVertices; ++k ) {
+			next = Vertex( (i + k) % numVertices );
+			if( ! SamePoint( p, next )) break;
+		}
+
+		d0[0] = p[0] - prev[0];
+		d0[1] = p[1] - prev[1];
+		len = sqrtf( d0[0]*d0[0] + d0[1]*d0[1] );
+		d0[0] /= len; d0[1] /= len;
+		d1[0] = next[0] - p[0];
+		d1[1] = next[1] - p[1];
+		len = sqrtf( d1[0]*d1[0] + d1[1]*d1[1] );
+		d1[0] /= len; d1[1] /= len;
+
+		/* Outward normals of a CCW contour. */
+		n0[0] = d0[1]; n0[1] = -d0[0];
+		n1[0] = d1[1]; n1[1] = -d1[0];
+
+		cross = d0[0]*d1[1] - d0[1]*d1[0];
+		dot = d0[0]*d1[0] + d0[1]*d1[1];
+
+		if( cross == 0 && dot > 0 ) {
+			/* Straight continuation. */
+			if ( !EmitPoint( &st, p[0] + n0[0]*offset, p[1] + n0[1]*offset )) return;
+		} else if( cross * offset < 0 ) {
+			/* The offset edges overlap, connect them through the vertex. */
+			if ( !EmitPoint( &st, p[0] + n0[0]*offset, p[1] + n0[1]*offset )) return;
+			if ( !EmitPoint( &st, p[0], p[1] )) return;
+			if ( !EmitPoint( &st, p[0] + n1[0]*offset, p[1] + n1[1]*offset )) return;
+		} else {
+			/* The offset edges diverge, turning by "angle" around the vertex.
+			* A reversal (cross == 0) goes around the vertex on the offset side.
+			*/
+			if( cross == 0 ) {
+				angle = offset > 0 ? TESS_PI : -TESS_PI;
+			} else {
+				angle = atan2f( cross, dot );
+			}
+			if ( !EmitJoin( &st, p, d0, n0, d1, n1, angle, offset,
+						   joinType, miterLimit, arcTolerance )) return;
+		}
+	}
+}
@@ -0,0 +1,388 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <math.h>
+#include "path.h"
+#include "capture.h"
+
+/* Curves are flattened uniformly in their parameter, using Wang's formula
+* to pick the number of segments: a polynomial curve of degree d whose
+* control polygon has maximum second difference M stays within "tol" of
+* its chords when split into ceil( sqrt( d*(d-1)/8 * M / tol ) ) pieces.
+* The segment count of each curve can thus be written as scale / sqrt(tol),
+* where the scale depends only on the curve.  Arcs use the same form by
+* approximating the chord error r*(1-cos(a/2)) with r*a*a/8.
+*/
+
+#define MAX_CURVE_SEGMENTS	1024
+
+static int CommandCoordCount( int cmd )
+{
+	switch( cmd ) {
+		case TESS_PATH_MOVETO:
+		case TESS_PATH_LINETO:
+			return 2;
+		case TESS_PATH_QUADTO:
+			return 4;
+		case TESS_PATH_CUBICTO:
+			return 6;
+		case TESS_PATH_ARCTO:
+			return 3;
+	}
+	return 0;
+}
+
+static TESSreal Len( TESSreal x, TESSreal y )
+{
+	return sqrtf( x*x + y*y );
+}
+
+TESSreal tessPathSegmentScale( int cmd, const TESSreal *p0, const TESSreal *c )
+{
+	TESSreal m0, m1, r, a;
+
+	switch( cmd ) {
+		case TESS_PATH_QUADTO:
+			m0 = Len( p0[0] - 2*c[0] + c[2], p0[1] - 2*c[1] + c[3] );
+			return sqrtf( m0 / 4 );
+		case TESS_PATH_CUBICTO:
+			m0 = Len( p0[0] - 2*c[0] + c[2], p0[1] - 2*c[1] + c[3] );
+			m1 = Len( c[0] - 2*c[2] + c[4], c[1] - 2*c[3] + c[5] );
+			return sqrtf( (m0 > m1 ? m0 : m1) * 3 / 4 );
+		case TESS_PATH_ARCTO:
+			r = Len( p0[0] - c[0], p0[1] - c[1] );
+			a = c[2] < 0 ? -c[2] : c[2];
+			return a * sqrtf( r / 8 );
+	}
+	return 0;
+}
+
+int tessPathSegmentCount( TESSreal scale, TESSreal tolerance )
+{
+	TESSreal n = ceilf( scale / sqrtf( tolerance ) );
+	if( n < 1 ) return 1;
+	if( n > MAX_CURVE_SEGMENTS ) return MAX_CURVE_SEGMENTS;
+	return (int)n;
+}
+
+/* Points are emitted one behind, so that the last point of a closed
+* contour can be dropped if it coincides with the first one.
+*/
+static int FlushPoint( TessPathBuilder *pb )
+{
+	if( pb->hasPending ) {
+		pb->e = tessAddContourVertex( pb->tess, pb->e, pb->pending[0], pb->pending[1], 0, pb->pendingIdx );
+		pb->hasPending = 0;
+		if( pb->e == NULL ) return 0;
+	}
+	return 1;
+}
+
+static int PathPoint( TessPathBuilder *pb, TESSreal x, TESSreal y, TESSindex idx )
+{
+	if( pb->hasPending && pb->pending[0] == x && pb->pending[1] == y ) return 1;
+	if ( !FlushPoint( pb )) return 0;
+	pb->pending[0] = x;
+	pb->pending[1] = y;
+	pb->pendingIdx = idx;
+	pb->hasPending = 1;
+	return 1;
+}
+
+int tessPathBegin( TessPathBuilder *pb, TESStesselator *tess )
+{
+	pb->tess = tess;
+	pb->e = NULL;
+	pb->hasPending = 0;
+	pb->current[0] = pb->current[1] = 0;
+	pb->start[0] = pb->start[1] = 0;
+	return tessBeginContour( tess, 0 );
+}
+
+int tessPathClose( TessPathBuilder *pb )
+{
+	if( pb->hasPending && pb->e != NULL
+		&& pb->pending[0] == pb->start[0] && pb->pending[1] == pb->start[1] ) {
+		pb->hasPending = 0;
+	}
+	if ( !FlushPoint( pb )) return 0;
+	pb->e = NULL;
+	pb->current[0] = pb->start[0];
+	pb->current[1] = pb->start[1];
+	return 1;
+}
+
+int tessPathSegment( TessPathBuilder *pb, int cmd, const TESSreal *c, int n, TESSindex idx )
+{
+	const TESSreal *p0 = pb->current;
+	TESSreal t, mt, x, y, a0 = 0, r = 0, da = 0;
+	int i;
+
+	switch( cmd ) {
+		case TESS_PATH_MOVETO:
+			if ( !tessPathClose( pb )) return 0;
+			pb->start[0] = c[0];
+			pb->start[1] = c[1];
+			if ( !PathPoint( pb, c[0], c[1], idx )) return 0;
+			break;
+
+		case TESS_PATH_LINETO:
+			if( pb->e == NULL && !pb->hasPending ) {
+				if ( !PathPoint( pb, p0[0], p0[1], idx )) return 0;
+			}
+			if ( !PathPoint( pb, c[0], c[1], idx )) return 0;
+			break;
+
+		case TESS_PATH_QUADTO:
+		case TESS_PATH_CUBICTO:
+		case TESS_PATH_ARCTO:
+			if( pb->e == NULL && !pb->hasPending ) {
+				if ( !PathPoint( pb, p0[0], p0[1], idx )) return 0;
+			}
+			if( cmd == TESS_PATH_ARCTO ) {
+				r = Len( p0[0] - c[0], p0[1] - c[1] );
+				a0 = atan2f( p0[1] - c[1], p0[0] - c[0] );
+				da = c[2] / n;
+			}
+			for( i = 1; i <= n; ++i ) {
+				t = (TESSreal)i / n;
+				mt = 1 - t;
+				if( cmd == TESS_PATH_QUADTO ) {
+					x = mt*mt*p0[0] + 2*mt*t*c[0] + t*t*c[2];
+					y = mt*mt*p0[1] + 2*mt*t*c[1] + t*t*c[3];
+				} else if( cmd == TESS_PATH_CUBICTO ) {
+					x = mt*mt*mt*p0[0] + 3*mt*mt*t*c[0] + 3*mt*t*t*c[2] + t*t*t*c[4];
+					y = mt*mt*mt*p0[1] + 3*mt*mt*t*c[1] + 3*mt*t*t*c[3] + t*t*t*c[5];
+				} else {
+					x = c[0] + r * cosf( a0 + da*i );
+					y = c[1] + r * sinf( a0 + da*i );
+				}
+				if ( !PathPoint( pb, x, y, idx )) return 0;
+			}
+			break;
+
+		case TESS_PATH_CLOSE:
+			return tessPathClose( pb );
+
+		default:
+			return 1;
+	}
+
+	/* Keep the exact end point as the start of the next segment. */
+	if( cmd == TESS_PATH_ARCTO ) {
+		pb->current[0] = pb->pending[0];
+		pb->current[1] = pb->pending[1];
+	} else {
+		pb->current[0] = c[CommandCoordCount(cmd)-2];
+		pb->current[1] = c[CommandCoordCount(cmd)-1];
+	}
+	return 1;
+}
+
+void tessAddPath( TESStesselator *tess, const unsigned char* commands, int commandCount,
+				  const TESSreal* coords, TESSreal tolerance )
+{
+	TessPathBuilder pb;
+	TESSindex base;
+	int i, n, cmd;
+
+	if( tolerance <= 0 )
+		tolerance = 0.25f;
+
+	if( tess->capture != NULL ) {
+		for( i = 0, n = 0; i < commandCount; ++i )
+			n += CommandCoordCount( commands[i] );
+		tessCapturePath( tess, commands, commandCount, coords, n, tolerance );
+	}
+
+	if ( !tessPathBegin( &pb, tess )) return;
+
+	base = tess->vertexIndexCounter;
+	tess->vertexIndexCounter += commandCount;
+
+	for( i = 0; i < commandCount; ++i ) {
+		cmd = commands[i];
+		n = tessPathSegmentCount( tessPathSegmentScale( cmd, pb.current, coords ), tolerance );
+		if ( !tessPathSegment( &pb, cmd, coords, n, base + i )) return;
+		coords += CommandCoordCount( cmd );
+	}
+	tessPathClose( &pb );
+}
+
+/* TESSlod keeps a copy of the path along with the per command values which
+* do not depend on the tolerance, so that flattening a level only needs to
+* evaluate the curves.
+*/
+struct TESSlod {
+	TESSalloc alloc;
+	int commandCount;
+	unsigned char *commands;
+	TESSreal *coords;
+	TESSreal *scales;	/* segment count scale of each command */
+	TESSreal *sizes;	/* extents of the sub-path started by each move-to */
+	TESSreal tolerance;
+	TESSreal ratio;
+};
+
+static void AddBounds( TESSreal *bmin, TESSreal *bmax, TESSreal x, TESSreal y )
+{
+	if( x < bmin[0] ) bmin[0] = x;
+	if( y < bmin[1] ) bmin[1] = y;
+	if( x > bmax[0] ) bmax[0] = x;
+	if( y > bmax[1] ) bmax[1] = y;
+}
+
+static void FinishSubpath( TESSlod *lod, int first, TESSreal *bmin, TESSreal *bmax )
+{
+	TESSreal w = bmax[0] - bmin[0];
+	TESSreal h = bmax[1] - bmin[1];
+	if( first >= 0 )
+		lod->sizes[first] = w > h ? w : h;
+}
+
+TESSlod* tessNewLod( TESSalloc* alloc, const unsigned char* commands, int commandCount,
+					 const TESSreal* coords, TESSreal tolerance, TESSreal ratio )
+{
+	TESSlod *lod;
+	TESSreal cur[2] = { 0, 0 }, start[2] = { 0, 0 };
+	TESSreal bmin[2] = { 0, 0 }, bmax[2] = { 0, 0 };
+	TESSreal r, a0;
+	const TESSreal *c;
+	int i, j, nc, coordCount = 0, first = -1;
+	size_t size;
+
+	if( alloc == NULL )
+		alloc = tessDefaultAlloc();
+
+	for( i = 0; i < commandCount; ++i )
+		coordCount += CommandCoordCount( commands[i] );
+
+	size = sizeof(TESSlod) + sizeof(TESSreal) * (coordCount + commandCount*2) + commandCount;
+	lod = (TESSlod*)alloc->memalloc( alloc->userData, size );
+	if( lod == NULL )
+		return 0;
+
+	lod->alloc = *alloc;
+	lod->commandCount = commandCount;
+	lod->coords = (TESSreal*)(lod + 1);
+	lod->scales = lod->coords + coordCount;
+	lod->sizes = lod->scales + commandCount;
+	lod->commands = (unsigned char*)(lod->sizes + commandCount);
+	lod->tolerance = tolerance > 0 ? tolerance : 0.25f;
+	lod->ratio = ratio > 1 ? ratio : 2;
+
+	for( i = 0; i < commandCount; ++i ) {
+		lod->commands[i] = commands[i];
+		lod->sizes[i] = 0;
+	}
+	for( i = 0; i < coordCount; ++i )
+		lod->coords[i] = coords[i];
+
+	/* Track the current point like TessPathBuilder does, and the bounds of
+	* the control points of each sub-path, which contain its curves. */
+	c = lod->coords;
+	for( i = 0; i < commandCount; ++i ) {
+		int cmd = commands[i];
+		nc = CommandCoordCount( cmd );
+		lod->scales[i] = tessPathSegmentScale( cmd, cur, c );
+		if( cmd == TESS_PATH_MOVETO ) {
+			FinishSubpath( lod, first, bmin, bmax );
+			first = i;
+			start[0] = bmin[0] = bmax[0] = c[0];
+			start[1] = bmin[1] = bmax[1] = c[1];
+			cur[0] = c[0];
+			cur[1] = c[1];
+		} else if( cmd == TESS_PATH_CLOSE ) {
+			cur[0] = start[0];
+			cur[1] = start[1];
+		} else if( cmd == TESS_PATH_ARCTO ) {
+			r = Len( cur[0] - c[0], cur[1] - c[1] );
+			a0 = atan2f( cur[1] - c[1], cur[0] - c[0] );
+			AddBounds( bmin, bmax, c[0] - r, c[1] - r );
+			AddBounds( bmin, bmax, c[0] + r, c[1] + r );
+			cur[0] = c[0] + r * cosf( a0 + c[2] );
+			cur[1] = c[1] + r * sinf( a0 + c[2] );
+		} else if( nc > 0 ) {
+			for( j = 0; j < nc; j += 2 )
+				AddBounds( bmin, bmax, c[j], c[j+1] );
+			cur[0] = c[nc-2];
+			cur[1] = c[nc-1];
+		}
+		c += nc;
+	}
+	FinishSubpath( lod, first, bmin, bmax );
+
+	return lod;
+}
+
+void tessDeleteLod( TESSlod* lod )
+{
+	if( lod == NULL ) return;
+	lod->alloc.memfree( lod->alloc.userData, lod );
+}
+
+TESSreal tessGetLodTolerance( const TESSlod* lod, int level )
+{
+	TESSreal tol = lod->tolerance;
+	while( level-- > 0 )
+		tol *= lod->ratio;
+	return tol;
+}
+
+void tessAddLodPath( TESStesselator *tess, const TESSlod* lod, int level )
+{
+	TessPathBuilder pb;
+	TESSindex base;
+	const TESSreal *c = lod->coords;
+	TESSreal tolerance = tessGetLodTolerance( lod, level );
+	int i, n, cmd, skip = 0;
+
+	/* The LOD chain is not part of the trace, replays will miss this input. */
+	if( tess->capture != NULL )
+		tessCaptureUnrecorded( tess );
+
+	if ( !tessPathBegin( &pb, tess )) return;
+
+	base = tess->vertexIndexCounter;
+	tess->vertexIndexCounter += lod->commandCount;
+
+	for( i = 0; i < lod->commandCount; c += CommandCoordCount( cmd ), ++i ) {
+		cmd = lod->commands[i];
+		if( cmd == TESS_PATH_MOVETO ) {
+			/* Sub-paths smaller than the tolerance would collapse anyway. */
+			skip = lod->sizes[i] < tolerance;
+			if( skip && !tessPathClose( &pb )) return;
+		}
+		if( skip )
+			continue;
+		n = tessPathSegmentCount( lod->scales[i], tolerance );
+		if ( !tessPathSegment( &pb, cmd, c, n, base + i )) return;
+	}
+	tessPathClose( &pb );
+}
@@ -0,0 +1,64 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#ifndef PATH_H
+#define PATH_H
+
+#include "tess.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* TessPathBuilder flattens path commands (see TessPathCommand) directly
+* into the input mesh of a tesselator.  Curves are split into the number of
+* segments passed to tessPathSegment(), which is normally computed with
+* tessPathSegmentCount( tessPathSegmentScale(...), tolerance ).
+*/
+typedef struct TessPathBuilder {
+	TESStesselator *tess;
+	TESShalfEdge *e;		/* last vertex of the contour being built */
+	TESSreal current[2];	/* current point of the path */
+	TESSreal start[2];		/* first point of the current sub-path */
+	TESSreal pending[2];	/* point waiting to be added to the mesh */
+	TESSindex pendingIdx;
+	int hasPending;
+} TessPathBuilder;
+
+int tessPathBegin( TessPathBuilder *pb, TESStesselator *tess );
+int tessPathSegment( TessPathBuilder *pb, int cmd, const TESSreal *coords, int n, TESSindex idx );
+int tessPathClose( TessPathBuilder *pb );
+
+TESSreal tessPathSegmentScale( int cmd, const TESSreal *p0, const TESSreal *coords );
+int tessPathSegmentCount( TESSreal scale, TESSreal tolerance );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
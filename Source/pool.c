@@ -0,0 +1,173 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include "tess.h"
+#include "thread.h"
+
+/* Tesselator pool.  Each pooled tesselator lives in a slot of a fixed
+* array, and the free slots form a lock-free stack.  The head of the stack
+* packs the index of the top slot plus one (0 when empty) in the low 16
+* bits and a tag in the bits above.  The tag changes on every update, so a
+* compare-and-swap fails if the slot was popped and pushed back meanwhile
+* (the ABA problem).  The head and the links are longs because those are
+* what the atomic operations in thread.h work on.
+*/
+
+#define POOL_INDEX_BITS	16
+#define POOL_INDEX_MASK	0xffffL
+#define POOL_TAG_MASK	0x7fffL		/* keeps the head positive in 32 bits */
+#define POOL_MAX_CAPACITY	0xffff
+
+typedef struct TessPoolSlot {
+	TESStesselator *tess;	/* created on first acquire */
+	volatile long next;		/* index+1 of the slot below in the stack */
+} TessPoolSlot;
+
+struct TESSpool {
+	TESSalloc alloc;
+	volatile long head;
+	TessPoolSlot *slots;
+	int capacity;
+};
+
+static long NextHead( long head, long index )
+{
+	long tag = ((head >> POOL_INDEX_BITS) + 1) & POOL_TAG_MASK;
+	return (tag << POOL_INDEX_BITS) | index;
+}
+
+static int PopSlot( TESSpool *pool )
+{
+	long head, index;
+
+	for( ;; ) {
+		head = tessAtomicLoad( &pool->head );
+		index = head & POOL_INDEX_MASK;
+		if( index == 0 )
+			return -1;
+		/* The link may be stale if another thread took the slot, in which
+		* case the tag has changed and the swap fails. */
+		if( tessAtomicCas( &pool->head, head, NextHead( head, pool->slots[index-1].next ) ) )
+			return (int)index - 1;
+	}
+}
+
+static void PushSlot( TESSpool *pool, int slot )
+{
+	long head;
+
+	for( ;; ) {
+		head = tessAtomicLoad( &pool->head );
+		pool->slots[slot].next = head & POOL_INDEX_MASK;
+		if( tessAtomicCas( &pool->head, head, NextHead( head, slot+1 ) ) )
+			return;
+	}
+}
+
+TESSpool* tessNewPool( TESSalloc* alloc, int capacity )
+{
+	TESSpool *pool;
+	int i;
+
+	if( alloc == NULL )
+		alloc = tessDefaultAlloc();
+	if( capacity < 1 || capacity > POOL_MAX_CAPACITY )
+		return 0;
+
+	pool = (TESSpool*)alloc->memalloc( alloc->userData, sizeof(TESSpool) );
+	if( pool == NULL )
+		return 0;
+	pool->alloc = *alloc;
+	pool->capacity = capacity;
+	pool->slots = (TessPoolSlot*)alloc->memalloc( alloc->userData, sizeof(TessPoolSlot) * capacity );
+	if( pool->slots == NULL ) {
+		alloc->memfree( alloc->userData, pool );
+		return 0;
+	}
+
+	/* Slot 0 on top, so that the same few tesselators get reused. */
+	for( i = 0; i < capacity; ++i ) {
+		pool->slots[i].tess = NULL;
+		pool->slots[i].next = i+1 < capacity ? i+2 : 0;
+	}
+	pool->head = 1;
+
+	return pool;
+}
+
+void tessDeletePool( TESSpool* pool )
+{
+	int i;
+
+	if( pool == NULL ) return;
+
+	for( i = 0; i < pool->capacity; ++i ) {
+		if( pool->slots[i].tess != NULL )
+			tessDeleteTess( pool->slots[i].tess );
+	}
+	pool->alloc.memfree( pool->alloc.userData, pool->slots );
+	pool->alloc.memfree( pool->alloc.userData, pool );
+}
+
+TESStesselator* tessPoolAcquire( TESSpool* pool )
+{
+	TESStesselator *tess;
+	int slot;
+
+	slot = PopSlot( pool );
+	if( slot < 0 ) {
+		/* All in use, hand out an unpooled tesselator. */
+		return tessNewTess( &pool->alloc );
+	}
+
+	/* The slot is owned by this thread until it is pushed back. */
+	tess = pool->slots[slot].tess;
+	if( tess == NULL ) {
+		tess = tessNewTess( &pool->alloc );
+		if( tess == NULL ) {
+			PushSlot( pool, slot );
+			return 0;
+		}
+		tess->poolSlot = slot;
+		pool->slots[slot].tess = tess;
+	}
+	return tess;
+}
+
+void tessPoolRelease( TESSpool* pool, TESStesselator* tess )
+{
+	if( tess == NULL ) return;
+
+	if( tess->poolSlot < 0 ) {
+		tessDeleteTess( tess );
+		return;
+	}
+	tessResetTess( tess );
+	PushSlot( pool, tess->poolSlot );
+}
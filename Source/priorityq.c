@@ -29,344 +29,158 @@
 ** Author: Eric Veach, July 1994.
 */
 
-//#include "tesos.h"
+
 #include <stddef.h>
 #include <assert.h>
 #include "../Include/tesselator.h"
+#include "geom.h"
 #include "priorityq.h"
 
 
-#define INIT_SIZE	32
-
 #define TRUE 1
 #define FALSE 0
 
-#ifdef FOR_TRITE_TEST_PROGRAM
-#define LEQ(x,y)	(*pq->leq)(x,y)
-#else
-/* Violates modularity, but a little faster */
-#include "geom.h"
-#define LEQ(x,y)	VertLeq((TESSvertex *)x, (TESSvertex *)y)
-#endif
-
-
-/* Include all the code for the regular heap-based queue here. */
-
-/* The basic operations are insertion of a new key (pqInsert),
-* and examination/extraction of a key whose value is minimum
-* (pqMinimum/pqExtractMin).  Deletion is also allowed (pqDelete);
-* for this purpose pqInsert returns a "handle" which is supplied
-* as the argument.
-*
-* An initial heap may be created efficiently by calling pqInsert
-* repeatedly, then calling pqInit.  In any case pqInit must be called
-* before any operations other than pqInsert are used.
-*
-* If the heap is empty, pqMinimum/pqExtractMin will return a NULL key.
-* This may also be tested with pqIsEmpty.
+/* Heap nodes have s and t members, so VertLeq() works on them as well as
+* on vertices.
 */
+#define LEQ(x,y)	VertLeq(x,y)
 
 
-/* Since we support deletion the data structure is a little more
-* complicated than an ordinary heap.  "nodes" is the heap itself;
-* active nodes are stored in the range 1..pq->size.  When the
-* heap exceeds its allocated size (pq->max), its size doubles.
-* The children of node i are nodes 2i and 2i+1.
-*
-* Each node stores an index into an array "handles".  Each handle
-* stores a key, plus a pointer back to the node which currently
-* represents that key (ie. nodes[handles[i].node].handle == i).
-*/
-
-
-#define pqHeapMinimum(pq)	((pq)->handles[(pq)->nodes[1].handle].key)
-#define pqHeapIsEmpty(pq)	((pq)->size == 0)
-
-
-
-/* really pqHeapNewPriorityQHeap */
-PriorityQHeap *pqHeapNewPriorityQ( TESSalloc* alloc, int size, int (*leq)(PQkey key1, PQkey key2) )
+PriorityQ *pqNewPriorityQ( TESSalloc* alloc, int size )
 {
-	PriorityQHeap *pq = (PriorityQHeap *)alloc->memalloc( alloc->userData, sizeof( PriorityQHeap ));
+	PriorityQ *pq = (PriorityQ *)alloc->memalloc( alloc->userData, sizeof( PriorityQ ));
 	if (pq == NULL) return NULL;
 
-	pq->size = 0;
-	pq->max = size;
-	pq->nodes = (PQnode *)alloc->memalloc( alloc->userData, (size + 1) * sizeof(pq->nodes[0]) );
-	if (pq->nodes == NULL) {
+	pq->order = (TESSvertex **)alloc->memalloc( alloc->userData, (size + 1) * sizeof(pq->order[0]) );
+	if (pq->order == NULL) {
 		alloc->memfree( alloc->userData, pq );
 		return NULL;
 	}
 
-	pq->handles = (PQhandleElem *)alloc->memalloc( alloc->userData, (size + 1) * sizeof(pq->handles[0]) );
-	if (pq->handles == NULL) {
-		alloc->memfree( alloc->userData, pq->nodes );
+	pq->heap = (PQnode *)alloc->memalloc( alloc->userData, (size + 1) * sizeof(pq->heap[0]) );
+	if (pq->heap == NULL) {
+		alloc->memfree( alloc->userData, pq->order );
 		alloc->memfree( alloc->userData, pq );
 		return NULL;
 	}
 
+	pq->size = 0;
+	pq->max = size + 1;
+	pq->heapSize = 0;
+	pq->heapMax = size + 1;
 	pq->initialized = FALSE;
-	pq->freeList = 0;
-	pq->leq = leq;
 
-	pq->nodes[1].handle = 1;	/* so that Minimum() returns NULL */
-	pq->handles[1].key = NULL;
 	return pq;
 }
 
-/* really pqHeapDeletePriorityQHeap */
-void pqHeapDeletePriorityQ( TESSalloc* alloc, PriorityQHeap *pq )
+void pqDeletePriorityQ( TESSalloc* alloc, PriorityQ *pq )
 {
-	alloc->memfree( alloc->userData, pq->handles );
-	alloc->memfree( alloc->userData, pq->nodes );
+	assert(pq != NULL);
+	alloc->memfree( alloc->userData, pq->heap );
+	alloc->memfree( alloc->userData, pq->order );
 	alloc->memfree( alloc->userData, pq );
 }
 
 
-static void FloatDown( PriorityQHeap *pq, int curr )
+/* The children of heap node i are nodes 4i+1 .. 4i+4. */
+
+static void FloatDown( PriorityQ *pq, int curr )
 {
-	PQnode *n = pq->nodes;
-	PQhandleElem *h = pq->handles;
-	PQhandle hCurr, hChild;
-	int child;
+	PQnode *h = pq->heap;
+	PQnode node = h[curr];
+	int child, last, i;
 
-	hCurr = n[curr].handle;
 	for( ;; ) {
-		child = curr << 1;
-		if( child < pq->size && LEQ( h[n[child+1].handle].key,
-			h[n[child].handle].key )) {
-				++child;
-		}
-
-		assert(child <= pq->max);
+		child = (curr << 2) + 1;
+		if( child >= pq->heapSize ) break;
 
-		hChild = n[child].handle;
-		if( child > pq->size || LEQ( h[hCurr].key, h[hChild].key )) {
-			n[curr].handle = hCurr;
-			h[hCurr].node = curr;
-			break;
+		last = child + 4;
+		if( last > pq->heapSize ) last = pq->heapSize;
+		for( i = child + 1; i < last; ++i ) {
+			if( ! LEQ( &h[child], &h[i] )) child = i;
 		}
-		n[curr].handle = hChild;
-		h[hChild].node = curr;
+		if( LEQ( &node, &h[child] )) break;
+
+		h[curr] = h[child];
+		h[curr].v->pqHandle = curr;
 		curr = child;
 	}
+	h[curr] = node;
+	node.v->pqHandle = curr;
 }
 
-
-static void FloatUp( PriorityQHeap *pq, int curr )
+static void FloatUp( PriorityQ *pq, int curr )
 {
-	PQnode *n = pq->nodes;
-	PQhandleElem *h = pq->handles;
-	PQhandle hCurr, hParent;
+	PQnode *h = pq->heap;
+	PQnode node = h[curr];
 	int parent;
 
-	hCurr = n[curr].handle;
-	for( ;; ) {
-		parent = curr >> 1;
-		hParent = n[parent].handle;
-		if( parent == 0 || LEQ( h[hParent].key, h[hCurr].key )) {
-			n[curr].handle = hCurr;
-			h[hCurr].node = curr;
-			break;
-		}
-		n[curr].handle = hParent;
-		h[hParent].node = curr;
-		curr = parent;
-	}
-}
-
-/* really pqHeapInit */
-void pqHeapInit( PriorityQHeap *pq )
-{
-	int i;
-
-	/* This method of building a heap is O(n), rather than O(n lg n). */
-
-	for( i = pq->size; i >= 1; --i ) {
-		FloatDown( pq, i );
-	}
-	pq->initialized = TRUE;
-}
-
-/* really pqHeapInsert */
-/* returns INV_HANDLE iff out of memory */
-PQhandle pqHeapInsert( TESSalloc* alloc, PriorityQHeap *pq, PQkey keyNew )
-{
-	int curr;
-	PQhandle free;
-
-	curr = ++ pq->size;
-	if( (curr*2) > pq->max ) {
-		if (!alloc->memrealloc)
-		{
-			return INV_HANDLE;
-		}
-		else
-		{
-			PQnode *saveNodes= pq->nodes;
-			PQhandleElem *saveHandles= pq->handles;
-
-			// If the heap overflows, double its size.
-			pq->max <<= 1;
-			pq->nodes = (PQnode *)alloc->memrealloc( alloc->userData, pq->nodes, 
-				(size_t)((pq->max + 1) * sizeof( pq->nodes[0] )));
-			if (pq->nodes == NULL) {
-				pq->nodes = saveNodes;	// restore ptr to free upon return 
-				return INV_HANDLE;
-			}
-			pq->handles = (PQhandleElem *)alloc->memrealloc( alloc->userData, pq->handles,
-				(size_t) ((pq->max + 1) * sizeof( pq->handles[0] )));
-			if (pq->handles == NULL) {
-				pq->handles = saveHandles; // restore ptr to free upon return 
-				return INV_HANDLE;
-			}
-		}
-	}
-
-	if( pq->freeList == 0 ) {
-		free = curr;
-	} else {
-		free = pq->freeList;
-		pq->freeList = pq->handles[free].node;
-	}
+	while( curr > 0 ) {
+		parent = (curr - 1) >> 2;
+		if( LEQ( &h[parent], &node )) break;
 
-	pq->nodes[curr].handle = free;
-	pq->handles[free].node = curr;
-	pq->handles[free].key = keyNew;
-
-	if( pq->initialized ) {
-		FloatUp( pq, curr );
+		h[curr] = h[parent];
+		h[curr].v->pqHandle = curr;
+		curr = parent;
 	}
-	assert(free != INV_HANDLE);
-	return free;
+	h[curr] = node;
+	node.v->pqHandle = curr;
 }
 
-/* really pqHeapExtractMin */
-PQkey pqHeapExtractMin( PriorityQHeap *pq )
+static PQhandle HeapInsert( TESSalloc* alloc, PriorityQ *pq, TESSvertex *v )
 {
-	PQnode *n = pq->nodes;
-	PQhandleElem *h = pq->handles;
-	PQhandle hMin = n[1].handle;
-	PQkey min = h[hMin].key;
-
-	if( pq->size > 0 ) {
-		n[1].handle = n[pq->size].handle;
-		h[n[1].handle].node = 1;
-
-		h[hMin].key = NULL;
-		h[hMin].node = pq->freeList;
-		pq->freeList = hMin;
-
-		if( -- pq->size > 0 ) {
-			FloatDown( pq, 1 );
-		}
+	PQnode *node;
+
+	if( pq->heapSize >= pq->heapMax ) {
+		PQnode *heap;
+		if (!alloc->memrealloc) return INV_HANDLE;
+		// If the heap overflows, double its size.
+		heap = (PQnode *)alloc->memrealloc( alloc->userData, pq->heap,
+			(size_t)(pq->heapMax * 2 * sizeof( pq->heap[0] )));
+		if (heap == NULL) return INV_HANDLE;
+		pq->heap = heap;
+		pq->heapMax *= 2;
 	}
-	return min;
-}
 
-/* really pqHeapDelete */
-void pqHeapDelete( PriorityQHeap *pq, PQhandle hCurr )
-{
-	PQnode *n = pq->nodes;
-	PQhandleElem *h = pq->handles;
-	int curr;
+	node = &pq->heap[pq->heapSize];
+	node->s = v->s;
+	node->t = v->t;
+	node->v = v;
+	FloatUp( pq, pq->heapSize++ );
 
-	assert( hCurr >= 1 && hCurr <= pq->max && h[hCurr].key != NULL );
-
-	curr = h[hCurr].node;
-	n[curr].handle = n[pq->size].handle;
-	h[n[curr].handle].node = curr;
-
-	if( curr <= -- pq->size ) {
-		if( curr <= 1 || LEQ( h[n[curr>>1].handle].key, h[n[curr].handle].key )) {
-			FloatDown( pq, curr );
-		} else {
-			FloatUp( pq, curr );
-		}
-	}
-	h[hCurr].key = NULL;
-	h[hCurr].node = pq->freeList;
-	pq->freeList = hCurr;
+	return v->pqHandle;
 }
 
-
-
-/* Now redefine all the function names to map to their "Sort" versions. */
-
-/* really tessPqSortNewPriorityQ */
-PriorityQ *pqNewPriorityQ( TESSalloc* alloc, int size, int (*leq)(PQkey key1, PQkey key2) )
+static void HeapDelete( PriorityQ *pq, int curr )
 {
-	PriorityQ *pq = (PriorityQ *)alloc->memalloc( alloc->userData, sizeof( PriorityQ ));
-	if (pq == NULL) return NULL;
+	PQnode *h = pq->heap;
 
-	pq->heap = pqHeapNewPriorityQ( alloc, size, leq );
-	if (pq->heap == NULL) {
-		alloc->memfree( alloc->userData, pq );
-		return NULL;
-	}
+	assert( curr >= 0 && curr < pq->heapSize );
 
-//	pq->keys = (PQkey *)memAlloc( INIT_SIZE * sizeof(pq->keys[0]) );
-	pq->keys = (PQkey *)alloc->memalloc( alloc->userData, size * sizeof(pq->keys[0]) );
-	if (pq->keys == NULL) {
-		pqHeapDeletePriorityQ( alloc, pq->heap );
-		alloc->memfree( alloc->userData, pq );
-		return NULL;
+	if( curr == -- pq->heapSize ) return;
+	h[curr] = h[pq->heapSize];
+	if( curr > 0 && ! LEQ( &h[(curr - 1) >> 2], &h[curr] )) {
+		FloatUp( pq, curr );
+	} else {
+		FloatDown( pq, curr );
 	}
-
-	pq->size = 0;
-	pq->max = size; //INIT_SIZE;
-	pq->initialized = FALSE;
-	pq->leq = leq;
-	
-	return pq;
-}
-
-/* really tessPqSortDeletePriorityQ */
-void pqDeletePriorityQ( TESSalloc* alloc, PriorityQ *pq )
-{
-	assert(pq != NULL); 
-	if (pq->heap != NULL) pqHeapDeletePriorityQ( alloc, pq->heap );
-	if (pq->order != NULL) alloc->memfree( alloc->userData, pq->order );
-	if (pq->keys != NULL) alloc->memfree( alloc->userData, pq->keys );
-	alloc->memfree( alloc->userData, pq );
 }
 
 
 #define LT(x,y)     (! LEQ(y,x))
 #define GT(x,y)     (! LEQ(x,y))
-#define Swap(a,b)   if(1){PQkey *tmp = *a; *a = *b; *b = tmp;}else
+#define Swap(a,b)   if(1){TESSvertex *tmp = *a; *a = *b; *b = tmp;}else
 
-/* really tessPqSortInit */
-int pqInit( TESSalloc* alloc, PriorityQ *pq )
+int pqInit( PriorityQ *pq )
 {
-	PQkey **p, **r, **i, **j, *piv;
-	struct { PQkey **p, **r; } Stack[50], *top = Stack;
+	TESSvertex **p, **r, **i, **j, *piv;
+	struct { TESSvertex **p, **r; } Stack[50], *top = Stack;
 	unsigned int seed = 2016473283;
+	int k;
 
-	/* Create an array of indirect pointers to the keys, so that we
-	* the handles we have returned are still valid.
-	*/
-	/*
-	pq->order = (PQkey **)memAlloc( (size_t)
-	(pq->size * sizeof(pq->order[0])) );
-	*/
-	pq->order = (PQkey **)alloc->memalloc( alloc->userData,
-										  (size_t)((pq->size+1) * sizeof(pq->order[0])) );
-	/* the previous line is a patch to compensate for the fact that IBM */
-	/* machines return a null on a malloc of zero bytes (unlike SGI),   */
-	/* so we have to put in this defense to guard against a memory      */
-	/* fault four lines down. from fossum@austin.ibm.com.               */
-	if (pq->order == NULL) return 0;
-
+	/* Sort the vertices in descending order, using randomized Quicksort */
 	p = pq->order;
 	r = p + pq->size - 1;
-	for( piv = pq->keys, i = p; i <= r; ++piv, ++i ) {
-		*i = piv;
-	}
-
-	/* Sort the indirect pointers in descending order,
-	* using randomized Quicksort
-	*/
 	top->p = p; top->r = r; ++top;
 	while( --top >= Stack ) {
 		p = top->p;
@@ -380,8 +194,8 @@ int pqInit( TESSalloc* alloc, PriorityQ *pq )
 			i = p - 1;
 			j = r + 1;
 			do {
-				do { ++i; } while( GT( **i, *piv ));
-				do { --j; } while( LT( **j, *piv ));
+				do { ++i; } while( GT( *i, piv ));
+				do { --j; } while( LT( *j, piv ));
 				Swap( i, j );
 			} while( i < j );
 			Swap( i, j ); /* Undo last swap */
@@ -396,35 +210,39 @@ int pqInit( TESSalloc* alloc, PriorityQ *pq )
 		/* Insertion sort small lists */
 		for( i = p+1; i <= r; ++i ) {
 			piv = *i;
-			for( j = i; j > p && LT( **(j-1), *piv ); --j ) {
+			for( j = i; j > p && LT( *(j-1), piv ); --j ) {
 				*j = *(j-1);
 			}
 			*j = piv;
 		}
 	}
-	pq->max = pq->size;
+
+	/* The handles returned by pqInsert were positions in insertion order;
+	* point them at the sorted slots instead.
+	*/
+	for( k = 0; k < pq->size; ++k ) {
+		pq->order[k]->pqHandle = -(k+1);
+	}
 	pq->initialized = TRUE;
-	pqHeapInit( pq->heap );  /* always succeeds */
 
 #ifndef NDEBUG
 	p = pq->order;
 	r = p + pq->size - 1;
 	for( i = p; i < r; ++i ) {
-		assert( LEQ( **(i+1), **i ));
+		assert( LEQ( *(i+1), *i ));
 	}
 #endif
 
 	return 1;
 }
 
-/* really tessPqSortInsert */
-/* returns INV_HANDLE iff out of memory */ 
+/* returns INV_HANDLE iff out of memory */
 PQhandle pqInsert( TESSalloc* alloc, PriorityQ *pq, PQkey keyNew )
 {
 	int curr;
 
 	if( pq->initialized ) {
-		return pqHeapInsert( alloc, pq->heap, keyNew );
+		return HeapInsert( alloc, pq, keyNew );
 	}
 	curr = pq->size;
 	if( ++ pq->size >= pq->max ) {
@@ -434,81 +252,73 @@ PQhandle pqInsert( TESSalloc* alloc, PriorityQ *pq, PQkey keyNew )
 		}
 		else
 		{
-			PQkey *saveKey= pq->keys;
-			// If the heap overflows, double its size.
+			TESSvertex **saveOrder = pq->order;
+			// If the array overflows, double its size.
 			pq->max <<= 1;
-			pq->keys = (PQkey *)alloc->memrealloc( alloc->userData, pq->keys, 
-				(size_t)(pq->max * sizeof( pq->keys[0] )));
-			if (pq->keys == NULL) { 
-				pq->keys = saveKey;  // restore ptr to free upon return 
+			pq->order = (TESSvertex **)alloc->memrealloc( alloc->userData, pq->order,
+				(size_t)(pq->max * sizeof( pq->order[0] )));
+			if (pq->order == NULL) {
+				pq->order = saveOrder;  // restore ptr to free upon return
 				return INV_HANDLE;
 			}
 		}
 	}
-	assert(curr != INV_HANDLE); 
-	pq->keys[curr] = keyNew;
+	assert(curr != INV_HANDLE);
+	pq->order[curr] = keyNew;
 
 	/* Negative handles index the sorted array. */
-	return -(curr+1);
+	keyNew->pqHandle = -(curr+1);
+	return keyNew->pqHandle;
 }
 
-/* really tessPqSortExtractMin */
 PQkey pqExtractMin( PriorityQ *pq )
 {
-	PQkey sortMin, heapMin;
+	TESSvertex *v;
 
-	if( pq->size == 0 ) {
-		return pqHeapExtractMin( pq->heap );
+	if( pq->heapSize > 0
+		&& (pq->size == 0 || LEQ( &pq->heap[0], pq->order[pq->size-1] ))) {
+		v = pq->heap[0].v;
+		HeapDelete( pq, 0 );
+		return v;
 	}
-	sortMin = *(pq->order[pq->size-1]);
-	if( ! pqHeapIsEmpty( pq->heap )) {
-		heapMin = pqHeapMinimum( pq->heap );
-		if( LEQ( heapMin, sortMin )) {
-			return pqHeapExtractMin( pq->heap );
-		}
+	if( pq->size == 0 ) {
+		return NULL;
 	}
+	v = pq->order[pq->size-1];
 	do {
 		-- pq->size;
-	} while( pq->size > 0 && *(pq->order[pq->size-1]) == NULL );
-	return sortMin;
+	} while( pq->size > 0 && pq->order[pq->size-1] == NULL );
+	return v;
 }
 
-/* really tessPqSortMinimum */
 PQkey pqMinimum( PriorityQ *pq )
 {
-	PQkey sortMin, heapMin;
-
-	if( pq->size == 0 ) {
-		return pqHeapMinimum( pq->heap );
+	if( pq->heapSize > 0
+		&& (pq->size == 0 || LEQ( &pq->heap[0], pq->order[pq->size-1] ))) {
+		return pq->heap[0].v;
 	}
-	sortMin = *(pq->order[pq->size-1]);
-	if( ! pqHeapIsEmpty( pq->heap )) {
-		heapMin = pqHeapMinimum( pq->heap );
-		if( LEQ( heapMin, sortMin )) {
-			return heapMin;
-		}
+	if( pq->size == 0 ) {
+		return NULL;
 	}
-	return sortMin;
+	return pq->order[pq->size-1];
 }
 
-/* really tessPqSortIsEmpty */
 int pqIsEmpty( PriorityQ *pq )
 {
-	return (pq->size == 0) && pqHeapIsEmpty( pq->heap );
+	return (pq->size == 0) && (pq->heapSize == 0);
 }
 
-/* really tessPqSortDelete */
 void pqDelete( PriorityQ *pq, PQhandle curr )
 {
 	if( curr >= 0 ) {
-		pqHeapDelete( pq->heap, curr );
+		HeapDelete( pq, curr );
 		return;
 	}
 	curr = -(curr+1);
-	assert( curr < pq->max && pq->keys[curr] != NULL );
+	assert( curr < pq->max && pq->order[curr] != NULL );
 
-	pq->keys[curr] = NULL;
-	while( pq->size > 0 && *(pq->order[pq->size-1]) == NULL ) {
+	pq->order[curr] = NULL;
+	while( pq->size > 0 && pq->order[pq->size-1] == NULL ) {
 		-- pq->size;
 	}
 }
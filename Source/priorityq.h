@@ -32,68 +32,50 @@
 #ifndef PRIORITYQ_H
 #define PRIORITYQ_H
 
-/* The basic operations are insertion of a new key (pqInsert),
-* and examination/extraction of a key whose value is minimum
-* (pqMinimum/pqExtractMin).  Deletion is also allowed (pqDelete);
-* for this purpose pqInsert returns a "handle" which is supplied
-* as the argument.
+#include "mesh.h"
+
+/* The event queue orders vertices by VertLeq().  The basic operations are
+* insertion of a new vertex (pqInsert), and examination/extraction of the
+* minimum vertex (pqMinimum/pqExtractMin).  Deletion is also allowed
+* (pqDelete), given the handle which pqInsert returned.
 *
-* An initial heap may be created efficiently by calling pqInsert
-* repeatedly, then calling pqInit.  In any case pqInit must be called
-* before any operations other than pqInsert are used.
+* The input vertices are inserted before calling pqInit, which sorts them
+* into a flat array that is then consumed from its end.  Vertices inserted
+* after pqInit (the intersection vertices created by the sweep) go into a
+* 4-ary heap.  Each heap node carries a copy of the (s,t) key, so sifting
+* only touches the heap array.  pqInit must be called before any operations
+* other than pqInsert are used.
 *
-* If the heap is empty, pqMinimum/pqExtractMin will return a NULL key.
-* This may also be tested with pqIsEmpty.
-*/
-
-/* Since we support deletion the data structure is a little more
-* complicated than an ordinary heap.  "nodes" is the heap itself;
-* active nodes are stored in the range 1..pq->size.  When the
-* heap exceeds its allocated size (pq->max), its size doubles.
-* The children of node i are nodes 2i and 2i+1.
+* The queue keeps the position of each vertex in v->pqHandle: a heap index
+* (>= 0), or -(i+1) for slot i of the sorted array.  pqInsert returns the
+* same value, or INV_HANDLE if it runs out of memory.
 *
-* Each node stores an index into an array "handles".  Each handle
-* stores a key, plus a pointer back to the node which currently
-* represents that key (ie. nodes[handles[i].node].handle == i).
+* If the queue is empty, pqMinimum/pqExtractMin will return NULL.
+* This may also be tested with pqIsEmpty.
 */
 
-typedef void *PQkey;
+typedef TESSvertex *PQkey;
 typedef int PQhandle;
-typedef struct PriorityQHeap PriorityQHeap;
+typedef struct PriorityQ PriorityQ;
 
 #define INV_HANDLE 0x0fffffff
 
-typedef struct { PQhandle handle; } PQnode;
-typedef struct { PQkey key; PQhandle node; } PQhandleElem;
-
-struct PriorityQHeap {
-
-	PQnode *nodes;
-	PQhandleElem *handles;
-	int size, max;
-	PQhandle freeList;
-	int initialized;
-
-	int (*leq)(PQkey key1, PQkey key2);
-};
-
-typedef struct PriorityQ PriorityQ;
+typedef struct { TESSreal s, t; TESSvertex *v; } PQnode;
 
 struct PriorityQ {
-	PriorityQHeap *heap;
+	TESSvertex **order;	/* input vertices, sorted in descending order */
+	int size, max;		/* live part of "order", and its capacity */
 
-	PQkey *keys;
-	PQkey **order;
-	PQhandle size, max;
-	int initialized;
+	PQnode *heap;		/* vertices inserted after pqInit */
+	int heapSize, heapMax;
 
-	int (*leq)(PQkey key1, PQkey key2);
+	int initialized;
 };
 
-PriorityQ *pqNewPriorityQ( TESSalloc* alloc, int size, int (*leq)(PQkey key1, PQkey key2) );
+PriorityQ *pqNewPriorityQ( TESSalloc* alloc, int size );
 void pqDeletePriorityQ( TESSalloc* alloc, PriorityQ *pq );
 
-int pqInit( TESSalloc* alloc, PriorityQ *pq );
+int pqInit( PriorityQ *pq );
 PQhandle pqInsert( TESSalloc* alloc, PriorityQ *pq, PQkey key );
 PQkey pqExtractMin( PriorityQ *pq );
 void pqDelete( PriorityQ *pq, PQhandle handle );
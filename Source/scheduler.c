@@ -0,0 +1,296 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include "scheduler.h"
+#include "tess.h"
+
+/* The worker running on this thread, if any. */
+static TESS_THREAD_LOCAL TessWorker *currentWorker = NULL;
+
+static TessDeque *OwnDeque( TESSscheduler *sched )
+{
+	if( currentWorker != NULL && currentWorker->sched == sched )
+		return &sched->deques[currentWorker->index];
+	return &sched->deques[sched->threadCount];
+}
+
+static void PushBottom( TessDeque *dq, TessTask *task )
+{
+	tessMutexLock( &dq->lock );
+	task->next = NULL;
+	task->prev = dq->bottom;
+	if( dq->bottom != NULL )
+		dq->bottom->next = task;
+	else
+		dq->top = task;
+	dq->bottom = task;
+	tessMutexUnlock( &dq->lock );
+}
+
+static TessTask *PopBottom( TessDeque *dq )
+{
+	TessTask *task;
+	tessMutexLock( &dq->lock );
+	task = dq->bottom;
+	if( task != NULL ) {
+		dq->bottom = task->prev;
+		if( dq->bottom != NULL )
+			dq->bottom->next = NULL;
+		else
+			dq->top = NULL;
+	}
+	tessMutexUnlock( &dq->lock );
+	return task;
+}
+
+static TessTask *PopTop( TessDeque *dq )
+{
+	TessTask *task;
+	tessMutexLock( &dq->lock );
+	task = dq->top;
+	if( task != NULL ) {
+		dq->top = task->next;
+		if( dq->top != NULL )
+			dq->top->prev = NULL;
+		else
+			dq->bottom = NULL;
+	}
+	tessMutexUnlock( &dq->lock );
+	return task;
+}
+
+/* Takes the newest task of the own deque, or steals the oldest task of
+* another deque.  Returns NULL if all the deques are empty. */
+static TessTask *FindTask( TESSscheduler *sched )
+{
+	TessDeque *own = OwnDeque( sched );
+	TessTask *task = NULL;
+	int n = sched->threadCount + 1;
+	int i, start;
+
+	if( tessAtomicLoad( &sched->queued ) == 0 )
+		return NULL;
+
+	task = PopBottom( own );
+	if( task == NULL ) {
+		/* Start from the next deque to spread the thieves. */
+		start = (int)(own - sched->deques) + 1;
+		for( i = 0; i < n && task == NULL; ++i ) {
+			TessDeque *dq = &sched->deques[(start + i) % n];
+			if( dq != own )
+				task = PopTop( dq );
+		}
+	}
+	if( task != NULL )
+		tessAtomicAdd( &sched->queued, -1 );
+	return task;
+}
+
+/* Wakes up the threads sleeping in WorkerMain() or tessSchedulerWait().
+* The sleepers announce themselves before checking their condition, and
+* the callers change the condition before calling this, so either the
+* sleeper sees the change or it is counted here (the atomics are full
+* barriers). */
+static void WakeSleepers( TESSscheduler *sched )
+{
+	if( tessAtomicLoad( &sched->sleeping ) == 0 )
+		return;
+	tessMutexLock( &sched->lock );
+	tessCondBroadcast( &sched->wake );
+	tessMutexUnlock( &sched->lock );
+}
+
+static void RunTask( TESSscheduler *sched, TessTask *task )
+{
+	TessTaskGroup *group = task->group;
+
+	task->func( task->data );
+
+	if( tessAtomicAdd( &group->pending, -1 ) == 0 ) {
+		/* Wake up the threads waiting for the group. */
+		WakeSleepers( sched );
+	}
+}
+
+static void WorkerMain( void *arg )
+{
+	TessWorker *worker = (TessWorker*)arg;
+	TESSscheduler *sched = worker->sched;
+	TessTask *task;
+	int quit;
+
+	currentWorker = worker;
+
+	for( ;; ) {
+		task = FindTask( sched );
+		if( task != NULL ) {
+			RunTask( sched, task );
+			continue;
+		}
+		tessMutexLock( &sched->lock );
+		tessAtomicAdd( &sched->sleeping, 1 );
+		while( tessAtomicLoad( &sched->queued ) == 0 && !sched->quit )
+			tessCondWait( &sched->wake, &sched->lock );
+		tessAtomicAdd( &sched->sleeping, -1 );
+		quit = sched->quit && tessAtomicLoad( &sched->queued ) == 0;
+		tessMutexUnlock( &sched->lock );
+		if( quit )
+			return;
+	}
+}
+
+void tessTaskGroupInit( TessTaskGroup *group )
+{
+	group->pending = 0;
+}
+
+void tessSchedulerSpawn( TESSscheduler *sched, TessTaskGroup *group, TessTask *task,
+						 TessTaskFunc *func, void *data )
+{
+	if( sched == NULL || sched->threadCount == 0 ) {
+		func( data );
+		return;
+	}
+
+	task->func = func;
+	task->data = data;
+	task->group = group;
+	tessAtomicAdd( &group->pending, 1 );
+
+	/* Counted before it is pushed, so that 'queued' never goes negative. */
+	tessAtomicAdd( &sched->queued, 1 );
+	PushBottom( OwnDeque( sched ), task );
+	WakeSleepers( sched );
+}
+
+void tessSchedulerWait( TESSscheduler *sched, TessTaskGroup *group )
+{
+	TessTask *task;
+
+	if( sched == NULL || sched->threadCount == 0 )
+		return;
+
+	while( tessAtomicLoad( &group->pending ) != 0 ) {
+		task = FindTask( sched );
+		if( task != NULL ) {
+			RunTask( sched, task );
+			continue;
+		}
+		tessMutexLock( &sched->lock );
+		tessAtomicAdd( &sched->sleeping, 1 );
+		if( tessAtomicLoad( &group->pending ) != 0 && tessAtomicLoad( &sched->queued ) == 0 )
+			tessCondWait( &sched->wake, &sched->lock );
+		tessAtomicAdd( &sched->sleeping, -1 );
+		tessMutexUnlock( &sched->lock );
+	}
+}
+
+TESSscheduler* tessNewScheduler( TESSalloc* alloc, int threadCount )
+{
+	TESSscheduler *sched;
+	int i;
+
+	if( alloc == NULL )
+		alloc = tessDefaultAlloc();
+	if( threadCount < 0 )
+		threadCount = tessProcessorCount() - 1;
+
+	sched = (TESSscheduler*)alloc->memalloc( alloc->userData, sizeof(TESSscheduler) );
+	if( sched == NULL )
+		return 0;
+	sched->alloc = *alloc;
+	sched->queued = 0;
+	sched->sleeping = 0;
+	sched->quit = 0;
+	sched->threadCount = threadCount;
+	sched->started = 0;
+	sched->workers = NULL;
+	sched->jobsSubmitted = 0;
+	sched->jobsCompleted = 0;
+	for( i = 0; i < TESS_LATENCY_BUCKETS; ++i )
+		sched->latency[i] = 0;
+	tessMutexInit( &sched->lock );
+	tessCondInit( &sched->wake );
+
+	sched->deques = (TessDeque*)alloc->memalloc( alloc->userData, sizeof(TessDeque) * (threadCount+1) );
+	if( sched->deques == NULL ) {
+		tessCondDestroy( &sched->wake );
+		tessMutexDestroy( &sched->lock );
+		alloc->memfree( alloc->userData, sched );
+		return 0;
+	}
+	for( i = 0; i <= threadCount; ++i ) {
+		tessMutexInit( &sched->deques[i].lock );
+		sched->deques[i].top = NULL;
+		sched->deques[i].bottom = NULL;
+	}
+
+	if( threadCount > 0 ) {
+		sched->workers = (TessWorker*)alloc->memalloc( alloc->userData, sizeof(TessWorker) * threadCount );
+		if( sched->workers == NULL ) {
+			tessDeleteScheduler( sched );
+			return 0;
+		}
+		for( i = 0; i < threadCount; ++i ) {
+			sched->workers[i].sched = sched;
+			sched->workers[i].index = i;
+			if( !tessThreadCreate( &sched->workers[i].thread, WorkerMain, &sched->workers[i] ) ) {
+				tessDeleteScheduler( sched );
+				return 0;
+			}
+			sched->started++;
+		}
+	}
+
+	return sched;
+}
+
+void tessDeleteScheduler( TESSscheduler* sched )
+{
+	int i;
+
+	if( sched == NULL ) return;
+
+	tessMutexLock( &sched->lock );
+	sched->quit = 1;
+	tessCondBroadcast( &sched->wake );
+	tessMutexUnlock( &sched->lock );
+
+	for( i = 0; i < sched->started; ++i )
+		tessThreadJoin( &sched->workers[i].thread );
+
+	if( sched->workers != NULL )
+		sched->alloc.memfree( sched->alloc.userData, sched->workers );
+	for( i = 0; i <= sched->threadCount; ++i )
+		tessMutexDestroy( &sched->deques[i].lock );
+	sched->alloc.memfree( sched->alloc.userData, sched->deques );
+	tessCondDestroy( &sched->wake );
+	tessMutexDestroy( &sched->lock );
+	sched->alloc.memfree( sched->alloc.userData, sched );
+}
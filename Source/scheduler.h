@@ -0,0 +1,118 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "thread.h"
+#include "../Include/tesselator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The scheduler runs tasks on a fixed set of worker threads.  Tasks are
+* spawned into a task group, and tessSchedulerWait() returns when all the
+* tasks of the group have finished.  The waiting thread runs queued tasks
+* while it waits, so tasks may spawn and wait for sub-tasks.
+*
+* Each worker has its own deque of tasks.  A worker pushes the tasks it
+* spawns to the bottom of its deque and takes its next task from the
+* bottom too, so nested tasks run depth first and stay in cache.  An idle
+* worker steals from the top of the other deques, which holds the oldest
+* and usually largest pieces of work.  Tasks spawned by other threads go
+* to a shared deque which everybody steals from.
+*
+* Task structs are owned by the caller and must stay alive until the group
+* has been waited for.  With a NULL scheduler (or one without workers)
+* tasks are run immediately by tessSchedulerSpawn().
+*/
+
+typedef struct TessTask TessTask;
+typedef struct TessTaskGroup TessTaskGroup;
+typedef struct TessDeque TessDeque;
+typedef void TessTaskFunc( void *data );
+
+struct TessTask {
+	TessTaskFunc *func;
+	void *data;
+	TessTaskGroup *group;
+	TessTask *prev;		/* towards the top of the deque */
+	TessTask *next;		/* towards the bottom of the deque */
+};
+
+struct TessTaskGroup {
+	volatile long pending;	/* number of spawned tasks not finished yet */
+};
+
+/* Doubly linked so that the tasks need no extra storage.  The lock is only
+* contended when the deque is being stolen from. */
+struct TessDeque {
+	TessMutex lock;
+	TessTask *top;
+	TessTask *bottom;
+};
+
+/* Job latencies are counted in buckets growing by sqrt(2), bucket i holds
+* latencies from 2^(i/2) to 2^((i+1)/2) microseconds. */
+#define TESS_LATENCY_BUCKETS	64
+
+typedef struct TessWorker {
+	TESSscheduler *sched;
+	int index;
+	TessThread thread;
+} TessWorker;
+
+struct TESSscheduler {
+	TESSalloc alloc;
+	TessMutex lock;
+	TessCond wake;		/* broadcast when tasks are queued, groups finish, or on quit */
+	volatile long queued;	/* number of tasks in all the deques */
+	volatile long sleeping;	/* number of threads waiting on 'wake' */
+	int quit;
+	int threadCount;
+	int started;		/* number of worker threads running */
+	TessDeque *deques;	/* one per worker, plus the shared one at [threadCount] */
+	TessWorker *workers;
+
+	/* Job statistics, see job.c */
+	volatile long jobsSubmitted;
+	volatile long jobsCompleted;
+	volatile long latency[TESS_LATENCY_BUCKETS];
+};
+
+void tessTaskGroupInit( TessTaskGroup *group );
+void tessSchedulerSpawn( TESSscheduler *sched, TessTaskGroup *group, TessTask *task,
+						 TessTaskFunc *func, void *data );
+void tessSchedulerWait( TESSscheduler *sched, TessTaskGroup *group );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -31,7 +31,6 @@
 
 #include <assert.h>
 #include <stddef.h>
-#include <setjmp.h>		/* longjmp */
 
 #include "mesh.h"
 #include "geom.h"
@@ -40,6 +39,7 @@
 #include "priorityq.h"
 #include "bucketalloc.h"
 #include "sweep.h"
+#include "trace.h"
 
 #define TRUE 1
 #define FALSE 0
@@ -89,10 +89,43 @@ extern void DebugEvent( TESStesselator *tess );
 #define AddWinding(eDst,eSrc)	(eDst->winding += eSrc->winding, \
 	eDst->Sym->winding += eSrc->Sym->winding)
 
-static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent );
-static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp );
+static int SweepEvent( TESStesselator *tess, TESSvertex *vEvent );
+static int WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp );
 static int CheckForRightSplice( TESStesselator *tess, ActiveRegion *regUp );
 
+/* Allocation failures are recorded in tess->error, and passed back up to
+* tessComputeInterior() by returning 0 (or NULL).  CheckForRightSplice(),
+* CheckForLeftSplice() and CheckForIntersect() return a boolean result,
+* so after calling them tess->error must be tested as well.
+*/
+static int OutOfMemory( TESStesselator *tess )
+{
+	tess->error = TESS_ERROR_OUT_OF_MEMORY;
+	return 0;
+}
+
+static double RegionEval( TESStesselator *tess, ActiveRegion *reg )
+/*
+* Returns EdgeEval() of the upper edge of "reg" at the current sweep event.
+* The same edge is typically compared against many others while the
+* dictionary is searched and the dirty regions are walked, so the value is
+* cached in the region.  It is recomputed when the upper edge changes
+* endpoints, or when tess->evalStamp changes (the event advanced, or a
+* vertex was moved).
+*/
+{
+	TESShalfEdge *e = reg->eUp;
+
+	if( reg->evalStamp != tess->evalStamp
+		|| reg->evalOrg != e->Org || reg->evalDst != e->Dst ) {
+		reg->evalT = EdgeEval( e->Dst, tess->event, e->Org );
+		reg->evalStamp = tess->evalStamp;
+		reg->evalOrg = e->Org;
+		reg->evalDst = e->Dst;
+	}
+	return reg->evalT;
+}
+
 static int EdgeLeq( TESStesselator *tess, ActiveRegion *reg1, ActiveRegion *reg2 )
 /*
 * Both edges must be directed from right to left (this is the canonical
@@ -108,7 +141,7 @@ static int EdgeLeq( TESStesselator *tess, ActiveRegion *reg1, ActiveRegion *reg2
 {
 	TESSvertex *event = tess->event;
 	TESShalfEdge *e1, *e2;
-	TESSreal t1, t2;
+	double t1, t2;
 
 	e1 = reg1->eUp;
 	e2 = reg2->eUp;
@@ -130,8 +163,8 @@ static int EdgeLeq( TESStesselator *tess, ActiveRegion *reg1, ActiveRegion *reg2
 	}
 
 	/* General case - compute signed distance *from* e1, e2 to event */
-	t1 = EdgeEval( e1->Dst, event, e1->Org );
-	t2 = EdgeEval( e2->Dst, event, e2->Org );
+	t1 = RegionEval( tess, reg1 );
+	t2 = RegionEval( tess, reg2 );
 	return (t1 >= t2);
 }
 
@@ -145,6 +178,7 @@ static void DeleteRegion( TESStesselator *tess, ActiveRegion *reg )
 		*/
 		assert( reg->eUp->winding == 0 );
 	}
+	if( ! reg->sentinel ) tess->activeRegionCount--;
 	reg->eUp->activeRegion = NULL;
 	dictDelete( tess->dict, reg->nodeUp );
 	bucketFree( tess->regionPool, reg );
@@ -209,14 +243,23 @@ static ActiveRegion *AddRegionBelow( TESStesselator *tess,
 */
 {
 	ActiveRegion *regNew = (ActiveRegion *)bucketAlloc( tess->regionPool );
-	if (regNew == NULL) longjmp(tess->env,1);
+	if (regNew == NULL) {
+		OutOfMemory( tess );
+		return NULL;
+	}
 
 	regNew->eUp = eNewUp;
+	regNew->evalStamp = tess->evalStamp - 1;
 	regNew->nodeUp = dictInsertBefore( tess->dict, regAbove->nodeUp, regNew );
-	if (regNew->nodeUp == NULL) longjmp(tess->env,1);
+	if (regNew->nodeUp == NULL) {
+		bucketFree( tess->regionPool, regNew );
+		OutOfMemory( tess );
+		return NULL;
+	}
 	regNew->fixUpperEdge = FALSE;
 	regNew->sentinel = FALSE;
 	regNew->dirty = FALSE;
+	tess->activeRegionCount++;
 
 	eNewUp->activeRegion = regNew;
 	return regNew;
@@ -263,7 +306,7 @@ static void FinishRegion( TESStesselator *tess, ActiveRegion *reg )
 	TESShalfEdge *e = reg->eUp;
 	TESSface *f = e->Lface;
 
-	f->inside = reg->inside;
+	tessMeshSetInside( tess->mesh, f, reg->inside );
 	f->anEdge = e;   /* optimization for tessMeshTessellateMonoRegion() */
 	DeleteRegion( tess, reg );
 }
@@ -281,7 +324,7 @@ static TESShalfEdge *FinishLeftRegions( TESStesselator *tess,
 * in the sweep).  The walk stops at the region above regLast; if regLast
 * is NULL we walk as far as possible.  At the same time we relink the
 * mesh if necessary, so that the ordering of edges around vOrg is the
-* same as in the dictionary.
+* same as in the dictionary.  Returns NULL if out of memory.
 */
 {
 	ActiveRegion *reg, *regPrev;
@@ -308,14 +351,19 @@ static TESShalfEdge *FinishLeftRegions( TESStesselator *tess,
 			* ConnectRightVertex, now is the time to fix it.
 			*/
 			e = tessMeshConnect( tess->mesh, ePrev->Lprev, e->Sym );
-			if (e == NULL) longjmp(tess->env,1);
-			if ( !FixUpperEdge( tess, reg, e ) ) longjmp(tess->env,1);
+			if (e == NULL || !FixUpperEdge( tess, reg, e )) {
+				OutOfMemory( tess );
+				return NULL;
+			}
 		}
 
 		/* Relink edges so that ePrev->Onext == e */
 		if( ePrev->Onext != e ) {
-			if ( !tessMeshSplice( tess->mesh, e->Oprev, e ) ) longjmp(tess->env,1);
-			if ( !tessMeshSplice( tess->mesh, ePrev, e ) ) longjmp(tess->env,1);
+			if ( !tessMeshSplice( tess->mesh, e->Oprev, e )
+				|| !tessMeshSplice( tess->mesh, ePrev, e ) ) {
+				OutOfMemory( tess );
+				return NULL;
+			}
 		}
 		FinishRegion( tess, regPrev );	/* may change reg->eUp */
 		ePrev = reg->eUp;
@@ -325,7 +373,7 @@ static TESShalfEdge *FinishLeftRegions( TESStesselator *tess,
 }
 
 
-static void AddRightEdges( TESStesselator *tess, ActiveRegion *regUp,
+static int AddRightEdges( TESStesselator *tess, ActiveRegion *regUp,
 						  TESShalfEdge *eFirst, TESShalfEdge *eLast, TESShalfEdge *eTopLeft,
 						  int cleanUp )
 /*
@@ -347,7 +395,7 @@ static void AddRightEdges( TESStesselator *tess, ActiveRegion *regUp,
 	e = eFirst;
 	do {
 		assert( VertLeq( e->Org, e->Dst ));
-		AddRegionBelow( tess, regUp, e->Sym );
+		if ( AddRegionBelow( tess, regUp, e->Sym ) == NULL ) return 0;
 		e = e->Onext;
 	} while ( e != eLast );
 
@@ -367,8 +415,8 @@ static void AddRightEdges( TESStesselator *tess, ActiveRegion *regUp,
 
 		if( e->Onext != ePrev ) {
 			/* Unlink e from its current position, and relink below ePrev */
-			if ( !tessMeshSplice( tess->mesh, e->Oprev, e ) ) longjmp(tess->env,1);
-			if ( !tessMeshSplice( tess->mesh, ePrev->Oprev, e ) ) longjmp(tess->env,1);
+			if ( !tessMeshSplice( tess->mesh, e->Oprev, e ) ) return OutOfMemory( tess );
+			if ( !tessMeshSplice( tess->mesh, ePrev->Oprev, e ) ) return OutOfMemory( tess );
 		}
 		/* Compute the winding number and "inside" flag for the new regions */
 		reg->windingNumber = regPrev->windingNumber - e->winding;
@@ -381,8 +429,9 @@ static void AddRightEdges( TESStesselator *tess, ActiveRegion *regUp,
 		if( ! firstTime && CheckForRightSplice( tess, regPrev )) {
 			AddWinding( e, ePrev );
 			DeleteRegion( tess, regPrev );
-			if ( !tessMeshDelete( tess->mesh, ePrev ) ) longjmp(tess->env,1);
+			if ( !tessMeshDelete( tess->mesh, ePrev ) ) return OutOfMemory( tess );
 		}
+		if( tess->error ) return 0;
 		firstTime = FALSE;
 		regPrev = reg;
 		ePrev = e;
@@ -392,19 +441,21 @@ static void AddRightEdges( TESStesselator *tess, ActiveRegion *regUp,
 
 	if( cleanUp ) {
 		/* Check for intersections between newly adjacent edges. */
-		WalkDirtyRegions( tess, regPrev );
+		return WalkDirtyRegions( tess, regPrev );
 	}
+	return 1;
 }
 
 
-static void SpliceMergeVertices( TESStesselator *tess, TESShalfEdge *e1,
+static int SpliceMergeVertices( TESStesselator *tess, TESShalfEdge *e1,
 								TESShalfEdge *e2 )
 /*
 * Two vertices with idential coordinates are combined into one.
 * e1->Org is kept, while e2->Org is discarded.
 */
 {
-	if ( !tessMeshSplice( tess->mesh, e1, e2 ) ) longjmp(tess->env,1); 
+	if ( !tessMeshSplice( tess->mesh, e1, e2 ) ) return OutOfMemory( tess );
+	return 1;
 }
 
 static void VertexWeights( TESSvertex *isect, TESSvertex *org, TESSvertex *dst,
@@ -483,22 +534,30 @@ static int CheckForRightSplice( TESStesselator *tess, ActiveRegion *regUp )
 		/* eUp->Org appears to be below eLo */
 		if( ! VertEq( eUp->Org, eLo->Org )) {
 			/* Splice eUp->Org into eLo */
-			if ( tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) longjmp(tess->env,1);
-			if ( !tessMeshSplice( tess->mesh, eUp, eLo->Oprev ) ) longjmp(tess->env,1);
+			if ( tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) return OutOfMemory( tess );
+			if ( !tessMeshSplice( tess->mesh, eUp, eLo->Oprev ) ) return OutOfMemory( tess );
 			regUp->dirty = regLo->dirty = TRUE;
+			tess->stats.rightSpliceCount++;
 
 		} else if( eUp->Org != eLo->Org ) {
 			/* merge the two vertices, discarding eUp->Org */
+			tess->stats.rightSpliceCount++;
 			pqDelete( tess->pq, eUp->Org->pqHandle );
-			SpliceMergeVertices( tess, eLo->Oprev, eUp );
+			if ( !SpliceMergeVertices( tess, eLo->Oprev, eUp ) ) return FALSE;
 		}
 	} else {
-		if( EdgeSign( eUp->Dst, eLo->Org, eUp->Org ) <= 0 ) return FALSE;
+		/* eLo->Org lying exactly on eUp must be spliced too, otherwise
+		* overlapping collinear edges (such as the boundary runs created by
+		* clipping) keep the shorter edge below the longer one, and edges
+		* added later at eLo->Org end up in the wrong place in the dictionary.
+		*/
+		if( EdgeSign( eUp->Dst, eLo->Org, eUp->Org ) < 0 ) return FALSE;
 
-		/* eLo->Org appears to be above eUp, so splice eLo->Org into eUp */
+		/* eLo->Org appears to be above or on eUp, so splice eLo->Org into eUp */
 		RegionAbove(regUp)->dirty = regUp->dirty = TRUE;
-		if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) longjmp(tess->env,1);
-		if ( !tessMeshSplice( tess->mesh, eLo->Oprev, eUp ) ) longjmp(tess->env,1);
+		tess->stats.rightSpliceCount++;
+		if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) return OutOfMemory( tess );
+		if ( !tessMeshSplice( tess->mesh, eLo->Oprev, eUp ) ) return OutOfMemory( tess );
 	}
 	return TRUE;
 }
@@ -535,19 +594,21 @@ static int CheckForLeftSplice( TESStesselator *tess, ActiveRegion *regUp )
 
 		/* eLo->Dst is above eUp, so splice eLo->Dst into eUp */
 		RegionAbove(regUp)->dirty = regUp->dirty = TRUE;
+		tess->stats.leftSpliceCount++;
 		e = tessMeshSplitEdge( tess->mesh, eUp );
-		if (e == NULL) longjmp(tess->env,1);
-		if ( !tessMeshSplice( tess->mesh, eLo->Sym, e ) ) longjmp(tess->env,1);
-		e->Lface->inside = regUp->inside;
+		if (e == NULL) return OutOfMemory( tess );
+		if ( !tessMeshSplice( tess->mesh, eLo->Sym, e ) ) return OutOfMemory( tess );
+		tessMeshSetInside( tess->mesh, e->Lface, regUp->inside );
 	} else {
 		if( EdgeSign( eLo->Dst, eUp->Dst, eLo->Org ) > 0 ) return FALSE;
 
 		/* eUp->Dst is below eLo, so splice eUp->Dst into eLo */
 		regUp->dirty = regLo->dirty = TRUE;
+		tess->stats.leftSpliceCount++;
 		e = tessMeshSplitEdge( tess->mesh, eLo );
-		if (e == NULL) longjmp(tess->env,1);    
-		if ( !tessMeshSplice( tess->mesh, eUp->Lnext, eLo->Sym ) ) longjmp(tess->env,1);
-		e->Rface->inside = regUp->inside;
+		if (e == NULL) return OutOfMemory( tess );
+		if ( !tessMeshSplice( tess->mesh, eUp->Lnext, eLo->Sym ) ) return OutOfMemory( tess );
+		tessMeshSetInside( tess->mesh, e->Rface, regUp->inside );
 	}
 	return TRUE;
 }
@@ -642,25 +703,26 @@ static int CheckForIntersect( TESStesselator *tess, ActiveRegion *regUp )
 		*/
 		if( dstLo == tess->event ) {
 			/* Splice dstLo into eUp, and process the new region(s) */
-			if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) longjmp(tess->env,1);
-			if ( !tessMeshSplice( tess->mesh, eLo->Sym, eUp ) ) longjmp(tess->env,1);
+			if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) return OutOfMemory( tess );
+			if ( !tessMeshSplice( tess->mesh, eLo->Sym, eUp ) ) return OutOfMemory( tess );
 			regUp = TopLeftRegion( tess, regUp );
-			if (regUp == NULL) longjmp(tess->env,1);
+			if (regUp == NULL) return OutOfMemory( tess );
 			eUp = RegionBelow(regUp)->eUp;
-			FinishLeftRegions( tess, RegionBelow(regUp), regLo );
-			AddRightEdges( tess, regUp, eUp->Oprev, eUp, eUp, TRUE );
+			if ( FinishLeftRegions( tess, RegionBelow(regUp), regLo ) == NULL ) return FALSE;
+			if ( !AddRightEdges( tess, regUp, eUp->Oprev, eUp, eUp, TRUE ) ) return FALSE;
 			return TRUE;
 		}
 		if( dstUp == tess->event ) {
 			/* Splice dstUp into eLo, and process the new region(s) */
-			if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) longjmp(tess->env,1);
-			if ( !tessMeshSplice( tess->mesh, eUp->Lnext, eLo->Oprev ) ) longjmp(tess->env,1); 
+			if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) return OutOfMemory( tess );
+			if ( !tessMeshSplice( tess->mesh, eUp->Lnext, eLo->Oprev ) ) return OutOfMemory( tess );
 			regLo = regUp;
 			regUp = TopRightRegion( regUp );
 			e = RegionBelow(regUp)->eUp->Rprev;
 			regLo->eUp = eLo->Oprev;
 			eLo = FinishLeftRegions( tess, regLo, NULL );
-			AddRightEdges( tess, regUp, eLo->Onext, eUp->Rprev, e, TRUE );
+			if ( eLo == NULL ) return FALSE;
+			if ( !AddRightEdges( tess, regUp, eLo->Onext, eUp->Rprev, e, TRUE ) ) return FALSE;
 			return TRUE;
 		}
 		/* Special case: called from ConnectRightVertex.  If either
@@ -669,15 +731,17 @@ static int CheckForIntersect( TESStesselator *tess, ActiveRegion *regUp )
 		*/
 		if( EdgeSign( dstUp, tess->event, &isect ) >= 0 ) {
 			RegionAbove(regUp)->dirty = regUp->dirty = TRUE;
-			if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) longjmp(tess->env,1);
+			if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) return OutOfMemory( tess );
 			eUp->Org->s = tess->event->s;
 			eUp->Org->t = tess->event->t;
+			tess->evalStamp++;
 		}
 		if( EdgeSign( dstLo, tess->event, &isect ) <= 0 ) {
 			regUp->dirty = regLo->dirty = TRUE;
-			if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) longjmp(tess->env,1);
+			if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) return OutOfMemory( tess );
 			eLo->Org->s = tess->event->s;
 			eLo->Org->t = tess->event->t;
+			tess->evalStamp++;
 		}
 		/* leave the rest for ConnectRightVertex */
 		return FALSE;
@@ -691,23 +755,37 @@ static int CheckForIntersect( TESStesselator *tess, ActiveRegion *regUp )
 	* the mesh (ie. eUp->Lface) to be smaller than the faces in the
 	* unprocessed original contours (which will be eLo->Oprev->Lface).
 	*/
-	if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) longjmp(tess->env,1);
-	if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) longjmp(tess->env,1);
-	if ( !tessMeshSplice( tess->mesh, eLo->Oprev, eUp ) ) longjmp(tess->env,1);
+	if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) return OutOfMemory( tess );
+	if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) return OutOfMemory( tess );
+	if ( !tessMeshSplice( tess->mesh, eLo->Oprev, eUp ) ) return OutOfMemory( tess );
 	eUp->Org->s = isect.s;
 	eUp->Org->t = isect.t;
+	tess->evalStamp++;
 	eUp->Org->pqHandle = pqInsert( &tess->alloc, tess->pq, eUp->Org );
 	if (eUp->Org->pqHandle == INV_HANDLE) {
-		pqDeletePriorityQ( &tess->alloc, tess->pq );
-		tess->pq = NULL;
-		longjmp(tess->env,1);
+		/* Without memrealloc the queue cannot grow past the extra
+		* vertices reserved by TESSalloc.extraVertices.
+		*/
+		OutOfMemory( tess );
+		if (tess->alloc.memrealloc == NULL)
+			tess->error = TESS_ERROR_BUDGET_EXCEEDED;
+		return FALSE;
 	}
 	GetIntersectData( tess, eUp->Org, orgUp, dstUp, orgLo, dstLo );
 	RegionAbove(regUp)->dirty = regUp->dirty = regLo->dirty = TRUE;
 	return FALSE;
 }
 
-static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
+static void CountDirtyWalk( TESStesselator *tess, int length )
+{
+	/* The mean is summed here, and divided in tessComputeInterior(). */
+	tess->stats.dirtyWalkCount++;
+	tess->stats.dirtyWalkMeanLength += length;
+	if( length > tess->stats.dirtyWalkMaxLength )
+		tess->stats.dirtyWalkMaxLength = length;
+}
+
+static int WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
 /*
 * When the upper or lower edge of any region changes, the region is
 * marked "dirty".  This routine walks through all the dirty regions
@@ -719,6 +797,7 @@ static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
 {
 	ActiveRegion *regLo = RegionBelow(regUp);
 	TESShalfEdge *eUp, *eLo;
+	int length = 0;
 
 	for( ;; ) {
 		/* Find the lowest dirty region (we walk from the bottom up). */
@@ -731,10 +810,12 @@ static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
 			regUp = RegionAbove( regUp );
 			if( regUp == NULL || ! regUp->dirty ) {
 				/* We've walked all the dirty regions */
-				return;
+				CountDirtyWalk( tess, length );
+				return 1;
 			}
 		}
 		regUp->dirty = FALSE;
+		length++;
 		eUp = regUp->eUp;
 		eLo = regLo->eUp;
 
@@ -748,16 +829,17 @@ static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
 				*/
 				if( regLo->fixUpperEdge ) {
 					DeleteRegion( tess, regLo );
-					if ( !tessMeshDelete( tess->mesh, eLo ) ) longjmp(tess->env,1);
+					if ( !tessMeshDelete( tess->mesh, eLo ) ) return OutOfMemory( tess );
 					regLo = RegionBelow( regUp );
 					eLo = regLo->eUp;
 				} else if( regUp->fixUpperEdge ) {
 					DeleteRegion( tess, regUp );
-					if ( !tessMeshDelete( tess->mesh, eUp ) ) longjmp(tess->env,1);
+					if ( !tessMeshDelete( tess->mesh, eUp ) ) return OutOfMemory( tess );
 					regUp = RegionAbove( regLo );
 					eUp = regUp->eUp;
 				}
 			}
+			if( tess->error ) return 0;
 		}
 		if( eUp->Org != eLo->Org ) {
 			if(    eUp->Dst != eLo->Dst
@@ -774,7 +856,8 @@ static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
 				*/
 				if( CheckForIntersect( tess, regUp )) {
 					/* WalkDirtyRegions() was called recursively; we're done */
-					return;
+					CountDirtyWalk( tess, length );
+					return 1;
 				}
 			} else {
 				/* Even though we can't use CheckForIntersect(), the Org vertices
@@ -782,19 +865,20 @@ static void WalkDirtyRegions( TESStesselator *tess, ActiveRegion *regUp )
 				*/
 				(void) CheckForRightSplice( tess, regUp );
 			}
+			if( tess->error ) return 0;
 		}
 		if( eUp->Org == eLo->Org && eUp->Dst == eLo->Dst ) {
 			/* A degenerate loop consisting of only two edges -- delete it. */
 			AddWinding( eLo, eUp );
 			DeleteRegion( tess, regUp );
-			if ( !tessMeshDelete( tess->mesh, eUp ) ) longjmp(tess->env,1);
+			if ( !tessMeshDelete( tess->mesh, eUp ) ) return OutOfMemory( tess );
 			regUp = RegionAbove( regLo );
 		}
 	}
 }
 
 
-static void ConnectRightVertex( TESStesselator *tess, ActiveRegion *regUp,
+static int ConnectRightVertex( TESStesselator *tess, ActiveRegion *regUp,
 							   TESShalfEdge *eBottomLeft )
 /*
 * Purpose: connect a "right" vertex vEvent (one where all edges go left)
@@ -837,27 +921,28 @@ static void ConnectRightVertex( TESStesselator *tess, ActiveRegion *regUp,
 
 	if( eUp->Dst != eLo->Dst ) {
 		(void) CheckForIntersect( tess, regUp );
+		if( tess->error ) return 0;
 	}
 
 	/* Possible new degeneracies: upper or lower edge of regUp may pass
 	* through vEvent, or may coincide with new intersection vertex
 	*/
 	if( VertEq( eUp->Org, tess->event )) {
-		if ( !tessMeshSplice( tess->mesh, eTopLeft->Oprev, eUp ) ) longjmp(tess->env,1);
+		if ( !tessMeshSplice( tess->mesh, eTopLeft->Oprev, eUp ) ) return OutOfMemory( tess );
 		regUp = TopLeftRegion( tess, regUp );
-		if (regUp == NULL) longjmp(tess->env,1);
+		if (regUp == NULL) return OutOfMemory( tess );
 		eTopLeft = RegionBelow( regUp )->eUp;
-		FinishLeftRegions( tess, RegionBelow(regUp), regLo );
+		if ( FinishLeftRegions( tess, RegionBelow(regUp), regLo ) == NULL ) return 0;
 		degenerate = TRUE;
 	}
 	if( VertEq( eLo->Org, tess->event )) {
-		if ( !tessMeshSplice( tess->mesh, eBottomLeft, eLo->Oprev ) ) longjmp(tess->env,1);
+		if ( !tessMeshSplice( tess->mesh, eBottomLeft, eLo->Oprev ) ) return OutOfMemory( tess );
 		eBottomLeft = FinishLeftRegions( tess, regLo, NULL );
+		if ( eBottomLeft == NULL ) return 0;
 		degenerate = TRUE;
 	}
 	if( degenerate ) {
-		AddRightEdges( tess, regUp, eBottomLeft->Onext, eTopLeft, eTopLeft, TRUE );
-		return;
+		return AddRightEdges( tess, regUp, eBottomLeft->Onext, eTopLeft, eTopLeft, TRUE );
 	}
 
 	/* Non-degenerate situation -- need to add a temporary, fixable edge.
@@ -869,14 +954,14 @@ static void ConnectRightVertex( TESStesselator *tess, ActiveRegion *regUp,
 		eNew = eUp;
 	}
 	eNew = tessMeshConnect( tess->mesh, eBottomLeft->Lprev, eNew );
-	if (eNew == NULL) longjmp(tess->env,1);
+	if (eNew == NULL) return OutOfMemory( tess );
 
 	/* Prevent cleanup, otherwise eNew might disappear before we've even
 	* had a chance to mark it as a temporary edge.
 	*/
-	AddRightEdges( tess, regUp, eNew, eNew->Onext, eNew->Onext, FALSE );
+	if ( !AddRightEdges( tess, regUp, eNew, eNew->Onext, eNew->Onext, FALSE ) ) return 0;
 	eNew->Sym->activeRegion->fixUpperEdge = TRUE;
-	WalkDirtyRegions( tess, regUp );
+	return WalkDirtyRegions( tess, regUp );
 }
 
 /* Because vertices at exactly the same location are merged together
@@ -888,7 +973,7 @@ static void ConnectRightVertex( TESStesselator *tess, ActiveRegion *regUp,
 */
 #define TOLERANCE_NONZERO	FALSE
 
-static void ConnectLeftDegenerate( TESStesselator *tess,
+static int ConnectLeftDegenerate( TESStesselator *tess,
 								  ActiveRegion *regUp, TESSvertex *vEvent )
 /*
 * The event vertex lies exacty on an already-processed edge or vertex.
@@ -905,21 +990,19 @@ static void ConnectLeftDegenerate( TESStesselator *tess,
 		* for e->Org to be pulled from the queue
 		*/
 		assert( TOLERANCE_NONZERO );
-		SpliceMergeVertices( tess, e, vEvent->anEdge );
-		return;
+		return SpliceMergeVertices( tess, e, vEvent->anEdge );
 	}
 
 	if( ! VertEq( e->Dst, vEvent )) {
 		/* General case -- splice vEvent into edge e which passes through it */
-		if (tessMeshSplitEdge( tess->mesh, e->Sym ) == NULL) longjmp(tess->env,1);
+		if (tessMeshSplitEdge( tess->mesh, e->Sym ) == NULL) return OutOfMemory( tess );
 		if( regUp->fixUpperEdge ) {
 			/* This edge was fixable -- delete unused portion of original edge */
-			if ( !tessMeshDelete( tess->mesh, e->Onext ) ) longjmp(tess->env,1);
+			if ( !tessMeshDelete( tess->mesh, e->Onext ) ) return OutOfMemory( tess );
 			regUp->fixUpperEdge = FALSE;
 		}
-		if ( !tessMeshSplice( tess->mesh, vEvent->anEdge, e ) ) longjmp(tess->env,1);
-		SweepEvent( tess, vEvent );	/* recurse */
-		return;
+		if ( !tessMeshSplice( tess->mesh, vEvent->anEdge, e ) ) return OutOfMemory( tess );
+		return SweepEvent( tess, vEvent );	/* recurse */
 	}
 
 	/* vEvent coincides with e->Dst, which has already been processed.
@@ -936,19 +1019,19 @@ static void ConnectLeftDegenerate( TESStesselator *tess,
 		*/
 		assert( eTopLeft != eTopRight );   /* there are some left edges too */
 		DeleteRegion( tess, reg );
-		if ( !tessMeshDelete( tess->mesh, eTopRight ) ) longjmp(tess->env,1);
+		if ( !tessMeshDelete( tess->mesh, eTopRight ) ) return OutOfMemory( tess );
 		eTopRight = eTopLeft->Oprev;
 	}
-	if ( !tessMeshSplice( tess->mesh, vEvent->anEdge, eTopRight ) ) longjmp(tess->env,1);
+	if ( !tessMeshSplice( tess->mesh, vEvent->anEdge, eTopRight ) ) return OutOfMemory( tess );
 	if( ! EdgeGoesLeft( eTopLeft )) {
 		/* e->Dst had no left-going edges -- indicate this to AddRightEdges() */
 		eTopLeft = NULL;
 	}
-	AddRightEdges( tess, regUp, eTopRight->Onext, eLast, eTopLeft, TRUE );
+	return AddRightEdges( tess, regUp, eTopRight->Onext, eLast, eTopLeft, TRUE );
 }
 
 
-static void ConnectLeftVertex( TESStesselator *tess, TESSvertex *vEvent )
+static int ConnectLeftVertex( TESStesselator *tess, TESSvertex *vEvent )
 /*
 * Purpose: connect a "left" vertex (one where both edges go right)
 * to the processed portion of the mesh.  Let R be the active region
@@ -968,25 +1051,32 @@ static void ConnectLeftVertex( TESStesselator *tess, TESSvertex *vEvent )
 	ActiveRegion *regUp, *regLo, *reg;
 	TESShalfEdge *eUp, *eLo, *eNew;
 	ActiveRegion tmp;
+	int steps;
 
 	/* assert( vEvent->anEdge->Onext->Onext == vEvent->anEdge ); */
 
 	/* Get a pointer to the active region containing vEvent */
 	tmp.eUp = vEvent->anEdge->Sym;
+	tmp.evalStamp = tess->evalStamp - 1;
 	/* __GL_DICTLISTKEY */ /* tessDictListSearch */
+	steps = tess->dict->searchSteps;
 	regUp = (ActiveRegion *)dictKey( dictSearch( tess->dict, &tmp ));
+	steps = tess->dict->searchSteps - steps;
+	tess->stats.dictSearchCount++;
+	tess->stats.dictSearchMeanSteps += steps;
+	if( steps > tess->stats.dictSearchMaxSteps )
+		tess->stats.dictSearchMaxSteps = steps;
 	regLo = RegionBelow( regUp );
 	if( !regLo ) {
 		// This may happen if the input polygon is coplanar.
-		return;
+		return 1;
 	}
 	eUp = regUp->eUp;
 	eLo = regLo->eUp;
 
 	/* Try merging with U or L first */
 	if( EdgeSign( eUp->Dst, vEvent, eUp->Org ) == 0 ) {
-		ConnectLeftDegenerate( tess, regUp, vEvent );
-		return;
+		return ConnectLeftDegenerate( tess, regUp, vEvent );
 	}
 
 	/* Connect vEvent to rightmost processed vertex of either chain.
@@ -997,29 +1087,31 @@ static void ConnectLeftVertex( TESStesselator *tess, TESSvertex *vEvent )
 	if( regUp->inside || reg->fixUpperEdge) {
 		if( reg == regUp ) {
 			eNew = tessMeshConnect( tess->mesh, vEvent->anEdge->Sym, eUp->Lnext );
-			if (eNew == NULL) longjmp(tess->env,1);
+			if (eNew == NULL) return OutOfMemory( tess );
 		} else {
 			TESShalfEdge *tempHalfEdge= tessMeshConnect( tess->mesh, eLo->Dnext, vEvent->anEdge);
-			if (tempHalfEdge == NULL) longjmp(tess->env,1);
+			if (tempHalfEdge == NULL) return OutOfMemory( tess );
 
 			eNew = tempHalfEdge->Sym;
 		}
 		if( reg->fixUpperEdge ) {
-			if ( !FixUpperEdge( tess, reg, eNew ) ) longjmp(tess->env,1);
+			if ( !FixUpperEdge( tess, reg, eNew ) ) return OutOfMemory( tess );
 		} else {
-			ComputeWinding( tess, AddRegionBelow( tess, regUp, eNew ));
+			reg = AddRegionBelow( tess, regUp, eNew );
+			if ( reg == NULL ) return 0;
+			ComputeWinding( tess, reg );
 		}
-		SweepEvent( tess, vEvent );
+		return SweepEvent( tess, vEvent );
 	} else {
 		/* The new vertex is in a region which does not belong to the polygon.
 		* We don''t need to connect this vertex to the rest of the mesh.
 		*/
-		AddRightEdges( tess, regUp, vEvent->anEdge, vEvent->anEdge, NULL, TRUE );
+		return AddRightEdges( tess, regUp, vEvent->anEdge, vEvent->anEdge, NULL, TRUE );
 	}
 }
 
 
-static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
+static int SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
 /*
 * Does everything necessary when the sweep line crosses a vertex.
 * Updates the mesh and the edge dictionary.
@@ -1029,6 +1121,7 @@ static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
 	TESShalfEdge *e, *eTopLeft, *eBottomLeft;
 
 	tess->event = vEvent;		/* for access in EdgeLeq() */
+	tess->evalStamp++;
 	DebugEvent( tess );
 
 	/* Check if this vertex is the right endpoint of an edge that is
@@ -1040,8 +1133,7 @@ static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
 		e = e->Onext;
 		if( e == vEvent->anEdge ) {
 			/* All edges go right -- not incident to any processed edges */
-			ConnectLeftVertex( tess, vEvent );
-			return;
+			return ConnectLeftVertex( tess, vEvent );
 		}
 	}
 
@@ -1053,10 +1145,11 @@ static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
 	* This takes care of all the left-going edges from vEvent.
 	*/
 	regUp = TopLeftRegion( tess, e->activeRegion );
-	if (regUp == NULL) longjmp(tess->env,1);
+	if (regUp == NULL) return OutOfMemory( tess );
 	reg = RegionBelow( regUp );
 	eTopLeft = reg->eUp;
 	eBottomLeft = FinishLeftRegions( tess, reg, NULL );
+	if (eBottomLeft == NULL) return 0;
 
 	/* Next we process all the right-going edges from vEvent.  This
 	* involves adding the edges to the dictionary, and creating the
@@ -1065,10 +1158,9 @@ static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
 	*/
 	if( eBottomLeft->Onext == eTopLeft ) {
 		/* No right-going edges -- add a temporary "fixable" edge */
-		ConnectRightVertex( tess, regUp, eBottomLeft );
-	} else {
-		AddRightEdges( tess, regUp, eBottomLeft->Onext, eTopLeft, eTopLeft, TRUE );
+		return ConnectRightVertex( tess, regUp, eBottomLeft );
 	}
+	return AddRightEdges( tess, regUp, eBottomLeft->Onext, eTopLeft, eTopLeft, TRUE );
 }
 
 
@@ -1076,7 +1168,7 @@ static void SweepEvent( TESStesselator *tess, TESSvertex *vEvent )
 * merged with real input features.
 */
 
-static void AddSentinel( TESStesselator *tess, TESSreal smin, TESSreal smax, TESSreal t )
+static int AddSentinel( TESStesselator *tess, TESSreal smin, TESSreal smax, TESSreal t )
 /*
 * We add two sentinel edges above and below all other edges,
 * to avoid special cases at the top and bottom.
@@ -1084,29 +1176,38 @@ static void AddSentinel( TESStesselator *tess, TESSreal smin, TESSreal smax, TES
 {
 	TESShalfEdge *e;
 	ActiveRegion *reg = (ActiveRegion *)bucketAlloc( tess->regionPool );
-	if (reg == NULL) longjmp(tess->env,1);
+	if (reg == NULL) return OutOfMemory( tess );
 
 	e = tessMeshMakeEdge( tess->mesh );
-	if (e == NULL) longjmp(tess->env,1);
+	if (e == NULL) {
+		bucketFree( tess->regionPool, reg );
+		return OutOfMemory( tess );
+	}
 
 	e->Org->s = smax;
 	e->Org->t = t;
 	e->Dst->s = smin;
 	e->Dst->t = t;
 	tess->event = e->Dst;		/* initialize it */
+	tess->evalStamp++;
 
 	reg->eUp = e;
+	reg->evalStamp = tess->evalStamp - 1;
 	reg->windingNumber = 0;
 	reg->inside = FALSE;
 	reg->fixUpperEdge = FALSE;
 	reg->sentinel = TRUE;
 	reg->dirty = FALSE;
 	reg->nodeUp = dictInsert( tess->dict, reg );
-	if (reg->nodeUp == NULL) longjmp(tess->env,1);
+	if (reg->nodeUp == NULL) {
+		bucketFree( tess->regionPool, reg );
+		return OutOfMemory( tess );
+	}
+	return 1;
 }
 
 
-static void InitEdgeDict( TESStesselator *tess )
+static int InitEdgeDict( TESStesselator *tess )
 /*
 * We maintain an ordering of edge intersections with the sweep line.
 * This order is maintained in a dynamic dictionary.
@@ -1116,7 +1217,8 @@ static void InitEdgeDict( TESStesselator *tess )
 	TESSreal smin, smax, tmin, tmax;
 
 	tess->dict = dictNewDict( &tess->alloc, tess, (int (*)(void *, DictKey, DictKey)) EdgeLeq );
-	if (tess->dict == NULL) longjmp(tess->env,1);
+	if (tess->dict == NULL) return OutOfMemory( tess );
+	tess->activeRegionCount = 0;
 
 	/* If the bbox is empty, ensure that sentinels are not coincident by slightly enlarging it. */
 	w = (tess->bmax[0] - tess->bmin[0]) + (TESSreal)0.01;
@@ -1127,8 +1229,8 @@ static void InitEdgeDict( TESStesselator *tess )
     tmin = tess->bmin[1] - h;
     tmax = tess->bmax[1] + h;
 
-	AddSentinel( tess, smin, smax, tmin );
-	AddSentinel( tess, smin, smax, tmax );
+	return AddSentinel( tess, smin, smax, tmin )
+		&& AddSentinel( tess, smin, smax, tmax );
 }
 
 
@@ -1151,11 +1253,13 @@ static void DoneEdgeDict( TESStesselator *tess )
 		DeleteRegion( tess, reg );
 		/*    tessMeshDelete( reg->eUp );*/
 	}
+	bucketAllocStats( tess->dict->nodePool, &tess->allocStats.buckets[TESS_BUCKETS_DICT_NODES] );
 	dictDeleteDict( &tess->alloc, tess->dict );
+	tess->dict = NULL;
 }
 
 
-static void RemoveDegenerateEdges( TESStesselator *tess )
+static int RemoveDegenerateEdges( TESStesselator *tess )
 /*
 * Remove zero-length edges, and contours with fewer than 3 vertices.
 */
@@ -1171,8 +1275,8 @@ static void RemoveDegenerateEdges( TESStesselator *tess )
 		if( VertEq( e->Org, e->Dst ) && e->Lnext->Lnext != e ) {
 			/* Zero-length edge, contour has at least 3 edges */
 
-			SpliceMergeVertices( tess, eLnext, e );	/* deletes e->Org */
-			if ( !tessMeshDelete( tess->mesh, e ) ) longjmp(tess->env,1); /* e is a self-loop */
+			if ( !SpliceMergeVertices( tess, eLnext, e ) ) return 0;	/* deletes e->Org */
+			if ( !tessMeshDelete( tess->mesh, e ) ) return OutOfMemory( tess ); /* e is a self-loop */
 			e = eLnext;
 			eLnext = e->Lnext;
 		}
@@ -1181,12 +1285,13 @@ static void RemoveDegenerateEdges( TESStesselator *tess )
 
 			if( eLnext != e ) {
 				if( eLnext == eNext || eLnext == eNext->Sym ) { eNext = eNext->next; }
-				if ( !tessMeshDelete( tess->mesh, eLnext ) ) longjmp(tess->env,1);
+				if ( !tessMeshDelete( tess->mesh, eLnext ) ) return OutOfMemory( tess );
 			}
 			if( e == eNext || e == eNext->Sym ) { eNext = eNext->next; }
-			if ( !tessMeshDelete( tess->mesh, e ) ) longjmp(tess->env,1);
+			if ( !tessMeshDelete( tess->mesh, e ) ) return OutOfMemory( tess );
 		}
 	}
+	return 1;
 }
 
 static int InitPriorityQ( TESStesselator *tess )
@@ -1197,16 +1302,12 @@ static int InitPriorityQ( TESStesselator *tess )
 {
 	PriorityQ *pq;
 	TESSvertex *v, *vHead;
-	int vertexCount = 0;
-	
-	vHead = &tess->mesh->vHead;
-	for( v = vHead->next; v != vHead; v = v->next ) {
-		vertexCount++;
-	}
+	int vertexCount = tess->mesh->vertexCount;
+
 	/* Make sure there is enough space for sentinels. */
 	vertexCount += MAX( 8, tess->alloc.extraVertices );
 	
-	pq = tess->pq = pqNewPriorityQ( &tess->alloc, vertexCount, (int (*)(PQkey, PQkey)) tesvertLeq );
+	pq = tess->pq = pqNewPriorityQ( &tess->alloc, vertexCount );
 	if (pq == NULL) return 0;
 
 	vHead = &tess->mesh->vHead;
@@ -1215,7 +1316,7 @@ static int InitPriorityQ( TESStesselator *tess )
 		if (v->pqHandle == INV_HANDLE)
 			break;
 	}
-	if (v != vHead || !pqInit( &tess->alloc, pq ) ) {
+	if (v != vHead || !pqInit( pq ) ) {
 		pqDeletePriorityQ( &tess->alloc, tess->pq );
 		tess->pq = NULL;
 		return 0;
@@ -1228,6 +1329,31 @@ static int InitPriorityQ( TESStesselator *tess )
 static void DonePriorityQ( TESStesselator *tess )
 {
 	pqDeletePriorityQ( &tess->alloc, tess->pq );
+	tess->pq = NULL;
+}
+
+
+static int AbortSweep( TESStesselator *tess )
+/*
+* Releases the sweep structures after an error part way through the
+* sweep.  The mesh is left in an inconsistent state and must be discarded.
+*/
+{
+	ActiveRegion *reg;
+
+	if( tess->dict != NULL ) {
+		while( (reg = (ActiveRegion *)dictKey( dictMin( tess->dict ))) != NULL ) {
+			reg->eUp->activeRegion = NULL;
+			dictDelete( tess->dict, reg->nodeUp );
+			bucketFree( tess->regionPool, reg );
+		}
+		dictDeleteDict( &tess->alloc, tess->dict );
+		tess->dict = NULL;
+	}
+	if( tess->pq != NULL ) {
+		DonePriorityQ( tess );
+	}
+	return 0;
 }
 
 
@@ -1265,6 +1391,19 @@ static int RemoveDegenerateFaces( TESStesselator *tess, TESSmesh *mesh )
 	return 1;
 }
 
+static void CountSweepEvent( TESStesselator *tess )
+{
+	int n = tess->activeRegionCount;
+	int bucket = 0;
+
+	while( (n >> (bucket+1)) != 0 && bucket < TESS_SWEEP_HISTOGRAM_SIZE-1 )
+		bucket++;
+	tess->stats.activeRegionHistogram[bucket]++;
+	tess->stats.sweepEventCount++;
+	if( n > tess->stats.maxActiveRegions )
+		tess->stats.maxActiveRegions = n;
+}
+
 int tessComputeInterior( TESStesselator *tess )
 /*
 * tessComputeInterior( tess ) computes the planar arrangement specified
@@ -1275,6 +1414,7 @@ int tessComputeInterior( TESStesselator *tess )
 */
 {
 	TESSvertex *v, *vNext;
+	double t0 = 0;
 
 	/* Each vertex defines an event for our sweep line.  Start by inserting
 	* all the vertices in a priority queue.  Events are processed in
@@ -1282,9 +1422,14 @@ int tessComputeInterior( TESStesselator *tess )
 	*
 	*	e1 < e2  iff  e1.x < e2.x || (e1.x == e2.x && e1.y < e2.y)
 	*/
-	RemoveDegenerateEdges( tess );
-	if ( !InitPriorityQ( tess ) ) return 0; /* if error */
-	InitEdgeDict( tess );
+	TESS_TRACE_BEGIN( tess, t0 );
+	if ( !RemoveDegenerateEdges( tess ) ) return 0;
+	TESS_TRACE_END( tess, "removeDegenerateEdges", t0 );
+	TESS_TRACE_BEGIN( tess, t0 );
+	if ( !InitPriorityQ( tess ) ) return OutOfMemory( tess ); /* if error */
+	TESS_TRACE_END( tess, "initPriorityQ", t0 );
+	TESS_TRACE_BEGIN( tess, t0 );
+	if ( !InitEdgeDict( tess ) ) return AbortSweep( tess );
 
 	while( (v = (TESSvertex *)pqExtractMin( tess->pq )) != NULL ) {
 		for( ;; ) {
@@ -1306,18 +1451,26 @@ int tessComputeInterior( TESStesselator *tess )
 			* when using boundary extraction (TESS_BOUNDARY_ONLY).
 			*/
 			vNext = (TESSvertex *)pqExtractMin( tess->pq );
-			SpliceMergeVertices( tess, v->anEdge, vNext->anEdge );
+			if ( !SpliceMergeVertices( tess, v->anEdge, vNext->anEdge ) ) return AbortSweep( tess );
 		}
-		SweepEvent( tess, v );
+		CountSweepEvent( tess );
+		if ( !SweepEvent( tess, v ) ) return AbortSweep( tess );
 	}
 
 	/* Set tess->event for debugging purposes */
 	tess->event = ((ActiveRegion *) dictKey( dictMin( tess->dict )))->eUp->Org;
 	DebugEvent( tess );
 	DoneEdgeDict( tess );
+	assert( tess->activeRegionCount == 0 );
 	DonePriorityQ( tess );
+	TESS_TRACE_END( tess, "sweep", t0 );
+
+	if( tess->stats.dictSearchCount > 0 )
+		tess->stats.dictSearchMeanSteps /= tess->stats.dictSearchCount;
+	if( tess->stats.dirtyWalkCount > 0 )
+		tess->stats.dirtyWalkMeanLength /= tess->stats.dirtyWalkCount;
 
-	if ( !RemoveDegenerateFaces( tess, tess->mesh ) ) return 0;
+	if ( !RemoveDegenerateFaces( tess, tess->mesh ) ) return OutOfMemory( tess );
 	tessMeshCheckMesh( tess->mesh );
 
 	return 1;
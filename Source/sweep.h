@@ -66,6 +66,10 @@ struct ActiveRegion {
 	int fixUpperEdge;	/* marks temporary edges introduced when
 						* we process a "right vertex" (one without
 						* any edges leaving to the right) */
+	unsigned int evalStamp;	/* tess->evalStamp when evalT was computed */
+	TESSvertex *evalOrg;	/* eUp->Org and eUp->Dst when evalT was computed */
+	TESSvertex *evalDst;
+	double evalT;		/* EdgeEval() of eUp at the sweep event */
 };
 
 #define RegionBelow(r) ((ActiveRegion *) dictKey(dictPred((r)->nodeUp)))
@@ -30,13 +30,16 @@
 */
 
 #include <stddef.h>
+#include <string.h>
 #include <assert.h>
-#include <setjmp.h>
 #include "bucketalloc.h"
 #include "tess.h"
 #include "mesh.h"
 #include "sweep.h"
 #include "geom.h"
+#include "scheduler.h"
+#include "capture.h"
+#include "trace.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -204,6 +207,56 @@ extern int RandomSweep;
 #endif
 #endif
 
+/* The dictionary holds the edges crossing the sweep line, so the average
+* dictionary size is about the sum of the edge extents along the sweep
+* direction divided by the extent of the whole input.  ChooseSweepDirection()
+* compares this estimate for sweeping along s and along t, and rotates the
+* projection by 90 degrees if sweeping along t is expected to keep fewer
+* edges active.  The rotation is exact, and keeps the orientation.
+*/
+static void ChooseSweepDirection( TESStesselator *tess )
+{
+	TESShalfEdge *e, *eHead = &tess->mesh->eHead;
+	TESSvertex *v, *vHead = &tess->mesh->vHead;
+	TESSreal smin, smax, tmin, tmax, ds, dt, tmp;
+	TESSreal sumS = 0, sumT = 0;
+	int i;
+
+	v = vHead->next;
+	if( v == vHead ) return;
+	smin = smax = v->s;
+	tmin = tmax = v->t;
+	for( v = v->next; v != vHead; v = v->next ) {
+		if( v->s < smin ) smin = v->s;
+		if( v->s > smax ) smax = v->s;
+		if( v->t < tmin ) tmin = v->t;
+		if( v->t > tmax ) tmax = v->t;
+	}
+
+	for( e = eHead->next; e != eHead; e = e->next ) {
+		ds = e->Org->s - e->Dst->s;
+		dt = e->Org->t - e->Dst->t;
+		sumS += ds < 0 ? -ds : ds;
+		sumT += dt < 0 ? -dt : dt;
+	}
+
+	/* sumT / (tmax-tmin) < sumS / (smax-smin) */
+	if( sumT * (smax - smin) >= sumS * (tmax - tmin) )
+		return;
+
+	/* (s,t) -> (t,-s) */
+	for( v = vHead->next; v != vHead; v = v->next ) {
+		tmp = v->s;
+		v->s = v->t;
+		v->t = -tmp;
+	}
+	for( i = 0; i < 3; ++i ) {
+		tmp = tess->sUnit[i];
+		tess->sUnit[i] = tess->tUnit[i];
+		tess->tUnit[i] = -tmp;
+	}
+}
+
 /* Determine the polygon normal and project vertices onto the plane
 * of the polygon.
 */
@@ -214,49 +267,51 @@ void tessProjectPolygon( TESStesselator *tess )
 	TESSreal *sUnit, *tUnit;
 	int i, first, computedNormal = FALSE;
 
-	norm[0] = tess->normal[0];
-	norm[1] = tess->normal[1];
-	norm[2] = tess->normal[2];
-	if( norm[0] == 0 && norm[1] == 0 && norm[2] == 0 ) {
-		ComputeNormal( tess, norm );
-		computedNormal = TRUE;
-	}
 	sUnit = tess->sUnit;
 	tUnit = tess->tUnit;
-	i = LongAxis( norm );
+	if( !tess->fixedProjection ) {
+		norm[0] = tess->normal[0];
+		norm[1] = tess->normal[1];
+		norm[2] = tess->normal[2];
+		if( norm[0] == 0 && norm[1] == 0 && norm[2] == 0 ) {
+			ComputeNormal( tess, norm );
+			computedNormal = TRUE;
+		}
+		i = LongAxis( norm );
 
 #if defined(FOR_TRITE_TEST_PROGRAM) || defined(TRUE_PROJECT)
-	/* Choose the initial sUnit vector to be approximately perpendicular
-	* to the normal.
-	*/
-	Normalize( norm );
-
-	sUnit[i] = 0;
-	sUnit[(i+1)%3] = S_UNIT_X;
-	sUnit[(i+2)%3] = S_UNIT_Y;
-
-	/* Now make it exactly perpendicular */
-	w = Dot( sUnit, norm );
-	sUnit[0] -= w * norm[0];
-	sUnit[1] -= w * norm[1];
-	sUnit[2] -= w * norm[2];
-	Normalize( sUnit );
-
-	/* Choose tUnit so that (sUnit,tUnit,norm) form a right-handed frame */
-	tUnit[0] = norm[1]*sUnit[2] - norm[2]*sUnit[1];
-	tUnit[1] = norm[2]*sUnit[0] - norm[0]*sUnit[2];
-	tUnit[2] = norm[0]*sUnit[1] - norm[1]*sUnit[0];
-	Normalize( tUnit );
+		/* Choose the initial sUnit vector to be approximately perpendicular
+		* to the normal.
+		*/
+		Normalize( norm );
+
+		sUnit[i] = 0;
+		sUnit[(i+1)%3] = S_UNIT_X;
+		sUnit[(i+2)%3] = S_UNIT_Y;
+
+		/* Now make it exactly perpendicular */
+		w = Dot( sUnit, norm );
+		sUnit[0] -= w * norm[0];
+		sUnit[1] -= w * norm[1];
+		sUnit[2] -= w * norm[2];
+		Normalize( sUnit );
+
+		/* Choose tUnit so that (sUnit,tUnit,norm) form a right-handed frame */
+		tUnit[0] = norm[1]*sUnit[2] - norm[2]*sUnit[1];
+		tUnit[1] = norm[2]*sUnit[0] - norm[0]*sUnit[2];
+		tUnit[2] = norm[0]*sUnit[1] - norm[1]*sUnit[0];
+		Normalize( tUnit );
 #else
-	/* Project perpendicular to a coordinate axis -- better numerically */
-	sUnit[i] = 0;
-	sUnit[(i+1)%3] = S_UNIT_X;
-	sUnit[(i+2)%3] = S_UNIT_Y;
-
-	tUnit[i] = 0;
-	tUnit[(i+1)%3] = (norm[i] > 0) ? -S_UNIT_Y : S_UNIT_Y;
-	tUnit[(i+2)%3] = (norm[i] > 0) ? S_UNIT_X : -S_UNIT_X;
+		/* Project perpendicular to a coordinate axis -- better numerically */
+		sUnit[i] = 0;
+		sUnit[(i+1)%3] = S_UNIT_X;
+		sUnit[(i+2)%3] = S_UNIT_Y;
+
+		tUnit[i] = 0;
+		tUnit[(i+1)%3] = (norm[i] > 0) ? -S_UNIT_Y : S_UNIT_Y;
+		tUnit[(i+2)%3] = (norm[i] > 0) ? S_UNIT_X : -S_UNIT_X;
 #endif
+	}
 
 	/* Project the vertices onto the sweep plane */
 	for( v = vHead->next; v != vHead; v = v->next )
@@ -264,9 +319,13 @@ void tessProjectPolygon( TESStesselator *tess )
 		v->s = Dot( v->coords, sUnit );
 		v->t = Dot( v->coords, tUnit );
 	}
+	if( tess->autoSweepDirection && !tess->fixedProjection ) {
+		ChooseSweepDirection( tess );
+	}
 	if( computedNormal ) {
 		CheckOrientation( tess );
 	}
+	tess->stats.sweepAxis = LongAxis( sUnit );
 
 	/* Compute ST bounds. */
 	first = 1;
@@ -393,6 +452,162 @@ int tessMeshTessellateInterior( TESSmesh *mesh )
 	return 1;
 }
 
+/* Interiors which need fewer diagonals are tessellated on the calling thread. */
+#define TESS_PARALLEL_INTERIOR_MIN	4096
+
+typedef struct RegionChunk {
+	TESSmesh *mesh;		/* allocates the new edges and faces, logs their insertion */
+	TESSmeshLog log;
+	TESSface **faces;
+	int count;
+	int result;
+	TessTask task;
+} RegionChunk;
+
+static void TessellateRegionChunk( void *data )
+{
+	RegionChunk *chunk = (RegionChunk*)data;
+	int i;
+
+	chunk->result = 1;
+	for( i = 0; i < chunk->count; ++i ) {
+		if ( !tessMeshTessellateMonoRegion( chunk->mesh, chunk->faces[i] ) ) {
+			chunk->result = 0;
+			return;
+		}
+	}
+}
+
+/* TagRegions( mesh ) numbers the monotone regions left by the sweep in
+* their face numbers, which the faces split from them keep (see InitFace()),
+* so that GroupFaces() can tell which region each output polygon comes from.
+*/
+static void TagRegions( TESSmesh *mesh )
+{
+	TESSface *f;
+	TESSindex region = 0;
+
+	for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+		f->n = f->inside ? region++ : TESS_UNDEF;
+	}
+}
+
+/* TessellateInterior( tess, mesh ) is tessMeshTessellateInterior() which
+* shares the regions among the threads of tess->sched.  A region only
+* modifies its own half-edges, so the threads need nothing but allocators
+* of their own; the list insertions are logged and replayed in the serial
+* order afterwards (see TESSmeshLog), which gives the very same mesh.
+*/
+static int TessellateInterior( TESStesselator *tess, TESSmesh *mesh )
+{
+	TESSscheduler *sched = tess->sched;
+	TESSalloc *alloc = &tess->alloc;
+	TESSface *f, **faces;
+	TESShalfEdge *e, **edgeLog;
+	TESSface **faceLog;
+	RegionChunk *chunks;
+	TessTaskGroup group;
+	int *diagonals;
+	int i, j, n, faceCount, total, target, chunkCount, rc;
+
+	if ( sched == NULL || sched->threadCount == 0 )
+		return tessMeshTessellateInterior( mesh );
+
+	/* A monotone region of n vertices is split by n-3 diagonals. */
+	faceCount = 0;
+	total = 0;
+	for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+		if( !f->inside ) continue;
+		n = 0;
+		e = f->anEdge;
+		do {
+			n++;
+			e = e->Lnext;
+		} while( e != f->anEdge );
+		faceCount++;
+		total += n - 3;
+	}
+	if ( total < TESS_PARALLEL_INTERIOR_MIN )
+		return tessMeshTessellateInterior( mesh );
+
+	target = total / (4 * (sched->threadCount + 1));
+	if ( target < 1 )
+		target = 1;
+	faces = (TESSface**)alloc->memalloc( alloc->userData, sizeof(TESSface*) * faceCount );
+	diagonals = (int*)alloc->memalloc( alloc->userData, sizeof(int) * faceCount );
+	edgeLog = (TESShalfEdge**)alloc->memalloc( alloc->userData, sizeof(TESShalfEdge*) * 2 * total );
+	faceLog = (TESSface**)alloc->memalloc( alloc->userData, sizeof(TESSface*) * 2 * total );
+	chunks = (RegionChunk*)alloc->memalloc( alloc->userData, sizeof(RegionChunk) * faceCount );
+	if ( faces == NULL || diagonals == NULL || edgeLog == NULL || faceLog == NULL || chunks == NULL ) {
+		if ( faces != NULL ) alloc->memfree( alloc->userData, faces );
+		if ( diagonals != NULL ) alloc->memfree( alloc->userData, diagonals );
+		if ( edgeLog != NULL ) alloc->memfree( alloc->userData, edgeLog );
+		if ( faceLog != NULL ) alloc->memfree( alloc->userData, faceLog );
+		if ( chunks != NULL ) alloc->memfree( alloc->userData, chunks );
+		return tessMeshTessellateInterior( mesh );
+	}
+
+	for( i = 0, f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+		if( !f->inside ) continue;
+		n = 0;
+		e = f->anEdge;
+		do {
+			n++;
+			e = e->Lnext;
+		} while( e != f->anEdge );
+		faces[i] = f;
+		diagonals[i] = n - 3;
+		i++;
+	}
+
+	/* Consecutive regions make up a chunk, with room in the log for
+	* exactly the diagonals of its regions. */
+	rc = 1;
+	chunkCount = 0;
+	tessTaskGroupInit( &group );
+	for( i = 0, total = 0; i < faceCount; ++chunkCount ) {
+		RegionChunk *chunk = &chunks[chunkCount];
+		chunk->faces = faces + i;
+		chunk->count = 0;
+		chunk->log.edges = edgeLog + total * 2;
+		chunk->log.faces = faceLog + total * 2;
+		chunk->log.edgeCount = 0;
+		chunk->log.faceCount = 0;
+		for( n = 0; i < faceCount && n < target; ++i ) {
+			n += diagonals[i];
+			chunk->count++;
+		}
+		chunk->log.maxCount = n;
+		total += n;
+		chunk->result = 0;
+		chunk->mesh = tessMeshNewMesh( alloc, 0 );
+		if ( chunk->mesh == NULL ) {
+			rc = 0;
+			continue;
+		}
+		chunk->mesh->log = &chunk->log;
+		tessSchedulerSpawn( sched, &group, &chunk->task, TessellateRegionChunk, chunk );
+	}
+	tessSchedulerWait( sched, &group );
+
+	for( j = 0; j < chunkCount; ++j ) {
+		if ( chunks[j].mesh == NULL )
+			continue;
+		tessMeshLinkLog( &chunks[j].log );
+		chunks[j].mesh->log = NULL;
+		mesh = tessMeshUnion( alloc, mesh, chunks[j].mesh );
+		if ( !chunks[j].result )
+			rc = 0;
+	}
+
+	alloc->memfree( alloc->userData, chunks );
+	alloc->memfree( alloc->userData, faceLog );
+	alloc->memfree( alloc->userData, edgeLog );
+	alloc->memfree( alloc->userData, diagonals );
+	alloc->memfree( alloc->userData, faces );
+	return rc;
+}
+
 
 typedef struct EdgeStackNode EdgeStackNode;
 typedef struct EdgeStack EdgeStack;
@@ -407,10 +622,13 @@ struct EdgeStack {
 	struct BucketAlloc *nodeBucket;
 };
 
-int stackInit( EdgeStack *stack, TESSalloc *alloc )
+int stackInit( EdgeStack *stack, TESSalloc *alloc, int edgeCount )
 {
+	/* All the internal edges are pushed at first, so a growing allocator
+	* starts from the number of edges. */
 	stack->top = NULL;
-	stack->nodeBucket = createBucketAlloc( alloc, "CDT nodes", sizeof(EdgeStackNode), 512 );
+	stack->nodeBucket = createBucketAlloc( alloc, "CDT nodes", sizeof(EdgeStackNode),
+										  alloc->adaptiveBuckets ? edgeCount : 512 );
 	return stack->nodeBucket != NULL;
 }
 
@@ -424,13 +642,14 @@ int stackEmpty( EdgeStack *stack )
 	return stack->top == NULL;
 }
 
-void stackPush( EdgeStack *stack, TESShalfEdge *e )
+int stackPush( EdgeStack *stack, TESShalfEdge *e )
 {
 	EdgeStackNode *node = (EdgeStackNode *)bucketAlloc( stack->nodeBucket );
-	if ( ! node ) return;
+	if ( ! node ) return 0;
 	node->edge = e;
 	node->next = stack->top;
 	stack->top = node;
+	return 1;
 }
 
 TESShalfEdge *stackPop( EdgeStack *stack )
@@ -448,7 +667,8 @@ TESShalfEdge *stackPop( EdgeStack *stack )
 
 //	Starting with a valid triangulation, uses the Edge Flip algorithm to
 //	refine the triangulation into a Constrained Delaunay Triangulation.
-void tessMeshRefineDelaunay( TESSmesh *mesh, TESSalloc *alloc )
+//	Returns 0 if out of memory, the triangulation is then valid but not refined.
+int tessMeshRefineDelaunay( TESSmesh *mesh, TESSalloc *alloc, TESSbucketStats *nodeStats )
 {
 	// At this point, we have a valid, but not optimal, triangulation.
 	// We refine the triangulation using the Edge Flip algorithm
@@ -460,16 +680,18 @@ void tessMeshRefineDelaunay( TESSmesh *mesh, TESSalloc *alloc )
 	TESSface *f;
 	EdgeStack stack;
 	TESShalfEdge *e;
-	int maxFaces = 0, maxIter = 0, iter = 0;
+	int maxFaces = 0, maxIter = 0, iter = 0, rc = 1;
 
-	stackInit(&stack, alloc);
+	if (!stackInit(&stack, alloc, mesh->edgeCount))
+		return 0;
 
 	for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
 		if ( f->inside) {
 			e = f->anEdge;
 			do {
 				e->mark = EdgeIsInternal(e); // Mark internal edges
-				if (e->mark && !e->Sym->mark) stackPush(&stack, e); // Insert into queue
+				if (e->mark && !e->Sym->mark && !stackPush(&stack, e)) // Insert into queue
+					rc = 0;
 				e = e->Lnext;
 			} while (e != f->anEdge);
 			maxFaces++;
@@ -483,7 +705,7 @@ void tessMeshRefineDelaunay( TESSmesh *mesh, TESSalloc *alloc )
 	// Pop stack until we find a reversed edge
 	// Flip the reversed edge, and insert any of the four opposite edges
 	// which are internal and not already in the stack (!marked)
-	while (!stackEmpty(&stack) && iter < maxIter) {
+	while (rc && !stackEmpty(&stack) && iter < maxIter) {
 		e = stackPop(&stack);
 		e->mark = e->Sym->mark = 0;
 		if (!tesedgeIsLocallyDelaunay(e)) {
@@ -498,14 +720,17 @@ void tessMeshRefineDelaunay( TESSmesh *mesh, TESSalloc *alloc )
 			for (i = 0; i < 4; i++) {
 				if (!edges[i]->mark && EdgeIsInternal(edges[i])) {
 					edges[i]->mark = edges[i]->Sym->mark = 1;
-					stackPush(&stack, edges[i]);
+					if (!stackPush(&stack, edges[i]))
+						rc = 0;
 				}
 			}
 		}
 		iter++;
 	}
 
+	bucketAllocStats( stack.nodeBucket, nodeStats );
 	stackDelete(&stack);
+	return rc;
 }
 
 
@@ -590,8 +815,38 @@ static TESSalloc defaulAlloc =
 	0,
 	0,
 	0,
+	0,
 };
 
+TESSalloc* tessDefaultAlloc( void )
+{
+	return &defaulAlloc;
+}
+
+/* tess->alloc routes the allocations through these to count them for
+* tessGetAllocStats(), the user data is the tesselator.
+*/
+static void* CountAlloc( void* userData, unsigned int size )
+{
+	TESStesselator *tess = (TESStesselator*)userData;
+	tessAtomicAdd( &tess->allocCount, 1 );
+	return tess->userAlloc.memalloc( tess->userAlloc.userData, size );
+}
+
+static void* CountRealloc( void *userData, void* ptr, unsigned int size )
+{
+	TESStesselator *tess = (TESStesselator*)userData;
+	tessAtomicAdd( &tess->reallocCount, 1 );
+	return tess->userAlloc.memrealloc( tess->userAlloc.userData, ptr, size );
+}
+
+static void CountFree( void* userData, void* ptr )
+{
+	TESStesselator *tess = (TESStesselator*)userData;
+	tessAtomicAdd( &tess->freeCount, 1 );
+	tess->userAlloc.memfree( tess->userAlloc.userData, ptr );
+}
+
 TESStesselator* tessNewTess( TESSalloc* alloc )
 {
 	TESStesselator* tess;
@@ -607,7 +862,16 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 	if ( tess == NULL ) {
 		return 0;          /* out of memory */
 	}
+	tess->userAlloc = *alloc;
 	tess->alloc = *alloc;
+	tess->alloc.memalloc = CountAlloc;
+	tess->alloc.memrealloc = alloc->memrealloc != NULL ? CountRealloc : NULL;
+	tess->alloc.memfree = CountFree;
+	tess->alloc.userData = tess;
+	tess->allocCount = 0;
+	tess->reallocCount = 0;
+	tess->freeCount = 0;
+	memset( &tess->allocStats, 0, sizeof(tess->allocStats) );
 	/* Check and set defaults. */
 	if (tess->alloc.meshEdgeBucketSize == 0)
 		tess->alloc.meshEdgeBucketSize = 512;
@@ -630,21 +894,38 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 	tess->bmax[1] = 0;
 
 	tess->reverseContours = 0;
+
+	tess->clipEnabled = 0;
+	tess->clipRect[0] = tess->clipRect[1] = 0;
+	tess->clipRect[2] = tess->clipRect[3] = 0;
     
 	tess->windingRule = TESS_WINDING_ODD;
 	tess->processCDT = 0;
+	tess->autoSweepDirection = 0;
+	tess->groupedOutput = 0;
+	tess->phaseTimings = 0;
+	tess->fixedProjection = 0;
+	tess->evalStamp = 0;
+	memset( &tess->stats, 0, sizeof(tess->stats) );
 
 	if (tess->alloc.regionBucketSize < 16)
 		tess->alloc.regionBucketSize = 16;
 	if (tess->alloc.regionBucketSize > 4096)
 		tess->alloc.regionBucketSize = 4096;
-	tess->regionPool = createBucketAlloc( &tess->alloc, "Regions",
-										 sizeof(ActiveRegion), tess->alloc.regionBucketSize );
+	tess->regionPool = createBucketAlloc( &tess->alloc, "Regions", sizeof(ActiveRegion),
+										 tess->alloc.adaptiveBuckets ? 0 : tess->alloc.regionBucketSize );
+	if ( tess->regionPool == NULL ) {
+		alloc->memfree( alloc->userData, tess );
+		return 0;          /* out of memory */
+	}
+
+	tess->dict = NULL;
+	tess->pq = NULL;
 
 	// Initialize to begin polygon.
 	tess->mesh = NULL;
 
-	tess->outOfMemory = 0;
+	tess->error = TESS_ERROR_NONE;
 	tess->vertexIndexCounter = 0;
 
 	tess->vertices = 0;
@@ -652,15 +933,74 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 	tess->vertexCount = 0;
 	tess->elements = 0;
 	tess->elementCount = 0;
+	tess->groups = 0;
+	tess->groupCount = 0;
+
+	tess->poolSlot = -1;
+	tess->sched = NULL;
+	tess->capture = NULL;
+	tess->tracer = NULL;
+	tess->traceCall = 0;
 
 	return tess;
 }
 
+void tessResetTess( TESStesselator *tess )
+{
+	tessEndCapture( tess );
+	if( tess->mesh != NULL ) {
+		tessMeshDeleteMesh( &tess->alloc, tess->mesh );
+		tess->mesh = NULL;
+	}
+	if (tess->vertices != NULL) {
+		tess->alloc.memfree( tess->alloc.userData, tess->vertices );
+		tess->vertices = 0;
+	}
+	if (tess->vertexIndices != NULL) {
+		tess->alloc.memfree( tess->alloc.userData, tess->vertexIndices );
+		tess->vertexIndices = 0;
+	}
+	if (tess->elements != NULL) {
+		tess->alloc.memfree( tess->alloc.userData, tess->elements );
+		tess->elements = 0;
+	}
+	if (tess->groups != NULL) {
+		tess->alloc.memfree( tess->alloc.userData, tess->groups );
+		tess->groups = 0;
+	}
+	tess->vertexCount = 0;
+	tess->elementCount = 0;
+	tess->groupCount = 0;
+	tess->vertexIndexCounter = 0;
+	tess->error = TESS_ERROR_NONE;
+
+	tess->normal[0] = 0;
+	tess->normal[1] = 0;
+	tess->normal[2] = 0;
+	tess->reverseContours = 0;
+	tess->clipEnabled = 0;
+	tess->windingRule = TESS_WINDING_ODD;
+	tess->processCDT = 0;
+	tess->autoSweepDirection = 0;
+	tess->groupedOutput = 0;
+	tess->phaseTimings = 0;
+	tess->fixedProjection = 0;
+	tess->sched = NULL;
+	tess->tracer = NULL;
+	memset( &tess->stats, 0, sizeof(tess->stats) );
+	tess->allocCount = 0;
+	tess->reallocCount = 0;
+	tess->freeCount = 0;
+	memset( &tess->allocStats, 0, sizeof(tess->allocStats) );
+}
+
 void tessDeleteTess( TESStesselator *tess )
 {
 
-	struct TESSalloc alloc = tess->alloc;
+	/* The counting allocator must not be used once the tesselator is freed. */
+	struct TESSalloc alloc = tess->userAlloc;
 
+	tessEndCapture( tess );
 	deleteBucketAlloc( tess->regionPool );
 
 	if( tess->mesh != NULL ) {
@@ -679,6 +1019,10 @@ void tessDeleteTess( TESStesselator *tess )
 		alloc.memfree( alloc.userData, tess->elements );
 		tess->elements = 0;
 	}
+	if (tess->groups != NULL) {
+		alloc.memfree( alloc.userData, tess->groups );
+		tess->groups = 0;
+	}
 
 	alloc.memfree( alloc.userData, tess );
 }
@@ -693,126 +1037,131 @@ static TESSindex GetNeighbourFace(TESShalfEdge* edge)
 	return edge->Rface->n;
 }
 
-void OutputPolymesh( TESStesselator *tess, TESSmesh *mesh, int elementType, int polySize, int vertexSize )
+/* Outputs with fewer faces are written on the calling thread. */
+#define TESS_PARALLEL_OUTPUT_MIN	8192
+
+typedef struct OutputChunk {
+	TESStesselator *tess;
+	TESSface **faces;
+	int count;
+	TESSindex vertexBase;	/* number of the first vertex numbered by this chunk */
+	int vertexCount;
+	int elementType;
+	int polySize;
+	int vertexSize;
+	TessTask task;
+} OutputChunk;
+
+/* Returns 1 if the half-edge "e" is where OutputPolymesh() meets its origin
+* first, walking the inside faces in order and each face from anEdge on.
+* The face numbers must be set.  Only the edges around the vertex are read,
+* so this can be asked for any vertex at any time.
+*/
+static int IsFirstUse( TESShalfEdge *e )
 {
-	TESSvertex* v = 0;
-	TESSface* f = 0;
-	TESShalfEdge* edge = 0;
-	int maxFaceCount = 0;
-	int maxVertexCount = 0;
-	int faceVerts, i;
-	TESSindex *elements = 0;
-	TESSreal *vert;
+	TESSface *f = e->Lface;
+	TESSface *f2;
+	TESShalfEdge *e2, *e3;
 
-	// Assume that the input data is triangles now.
-	// Try to merge as many polygons as possible
-	if (polySize > 3)
+	for ( e2 = e->Onext; e2 != e; e2 = e2->Onext )
 	{
-		if (!tessMeshMergeConvexFaces( mesh, polySize ))
+		f2 = e2->Lface;
+		if ( f2 == NULL || !f2->inside ) continue;
+		if ( f2->n < f->n ) return 0;
+		if ( f2 == f )
 		{
-			tess->outOfMemory = 1;
-			return;
+			// The face visits the vertex twice, the first visit counts.
+			for ( e3 = f->anEdge; e3 != e && e3 != e2; e3 = e3->Lnext )
+				;
+			if ( e3 == e2 ) return 0;
 		}
 	}
+	return 1;
+}
 
-	// Mark unused
-	for ( v = mesh->vHead.next; v != &mesh->vHead; v = v->next )
-		v->n = TESS_UNDEF;
+static void CountOutputChunk( void *data )
+{
+	OutputChunk *chunk = (OutputChunk*)data;
+	TESShalfEdge *edge;
+	int i, faceVerts;
 
-	// Create unique IDs for all vertices and faces.
-	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
+	chunk->vertexCount = 0;
+	for ( i = 0; i < chunk->count; ++i )
 	{
-		f->n = TESS_UNDEF;
-		if( !f->inside ) continue;
-
-		edge = f->anEdge;
+		edge = chunk->faces[i]->anEdge;
 		faceVerts = 0;
 		do
 		{
-			v = edge->Org;
-			if ( v->n == TESS_UNDEF )
-			{
-				v->n = maxVertexCount;
-				maxVertexCount++;
-			}
+			if ( IsFirstUse( edge ) )
+				chunk->vertexCount++;
 			faceVerts++;
 			edge = edge->Lnext;
 		}
-		while (edge != f->anEdge);
-
-		assert( faceVerts <= polySize );
-
-		f->n = maxFaceCount;
-		++maxFaceCount;
-	}
-
-	tess->elementCount = maxFaceCount;
-	if (elementType == TESS_CONNECTED_POLYGONS)
-		maxFaceCount *= 2;
-	tess->elements = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-													  sizeof(TESSindex) * maxFaceCount * polySize );
-	if (!tess->elements)
-	{
-		tess->outOfMemory = 1;
-		return;
-	}
+		while (edge != chunk->faces[i]->anEdge);
 
-	tess->vertexCount = maxVertexCount;
-	tess->vertices = (TESSreal*)tess->alloc.memalloc( tess->alloc.userData,
-													 sizeof(TESSreal) * tess->vertexCount * vertexSize );
-	if (!tess->vertices)
-	{
-		tess->outOfMemory = 1;
-		return;
+		assert( faceVerts <= chunk->polySize );
 	}
+}
 
-	tess->vertexIndices = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-														    sizeof(TESSindex) * tess->vertexCount );
-	if (!tess->vertexIndices)
-	{
-		tess->outOfMemory = 1;
-		return;
-	}
+static void WriteOutputVertices( void *data )
+{
+	OutputChunk *chunk = (OutputChunk*)data;
+	TESStesselator *tess = chunk->tess;
+	TESShalfEdge *edge;
+	TESSvertex *v;
+	TESSreal *vert;
+	TESSindex n = chunk->vertexBase;
+	int i;
 
-	// Output vertices.
-	for ( v = mesh->vHead.next; v != &mesh->vHead; v = v->next )
+	for ( i = 0; i < chunk->count; ++i )
 	{
-		if ( v->n != TESS_UNDEF )
+		edge = chunk->faces[i]->anEdge;
+		do
 		{
-			// Store coordinate
-			vert = &tess->vertices[v->n*vertexSize];
-			vert[0] = v->coords[0];
-			vert[1] = v->coords[1];
-			if ( vertexSize > 2 )
-				vert[2] = v->coords[2];
-			// Store vertex index.
-			tess->vertexIndices[v->n] = v->idx;
+			if ( IsFirstUse( edge ) )
+			{
+				v = edge->Org;
+				v->n = n++;
+				vert = &tess->vertices[v->n*chunk->vertexSize];
+				vert[0] = v->coords[0];
+				vert[1] = v->coords[1];
+				if ( chunk->vertexSize > 2 )
+					vert[2] = v->coords[2];
+				tess->vertexIndices[v->n] = v->idx;
+			}
+			edge = edge->Lnext;
 		}
+		while (edge != chunk->faces[i]->anEdge);
 	}
+}
 
-	// Output indices.
-	elements = tess->elements;
-	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
+static void WriteOutputElements( void *data )
+{
+	OutputChunk *chunk = (OutputChunk*)data;
+	TESSface *f;
+	TESShalfEdge *edge;
+	TESSindex *elements;
+	int i, j, faceVerts;
+	int stride = chunk->elementType == TESS_CONNECTED_POLYGONS ? chunk->polySize * 2 : chunk->polySize;
+
+	for ( i = 0; i < chunk->count; ++i )
 	{
-		if ( !f->inside ) continue;
+		f = chunk->faces[i];
+		elements = chunk->tess->elements + f->n * stride;
 
-		// Store polygon
 		edge = f->anEdge;
 		faceVerts = 0;
 		do
 		{
-			v = edge->Org;
-			*elements++ = v->n;
+			*elements++ = edge->Org->n;
 			faceVerts++;
 			edge = edge->Lnext;
 		}
 		while (edge != f->anEdge);
-		// Fill unused.
-		for (i = faceVerts; i < polySize; ++i)
+		for (j = faceVerts; j < chunk->polySize; ++j)
 			*elements++ = TESS_UNDEF;
 
-		// Store polygon connectivity
-		if ( elementType == TESS_CONNECTED_POLYGONS )
+		if ( chunk->elementType == TESS_CONNECTED_POLYGONS )
 		{
 			edge = f->anEdge;
 			do
@@ -821,71 +1170,469 @@ void OutputPolymesh( TESStesselator *tess, TESSmesh *mesh, int elementType, int
 				edge = edge->Lnext;
 			}
 			while (edge != f->anEdge);
-			// Fill unused.
-			for (i = faceVerts; i < polySize; ++i)
+			for (j = faceVerts; j < chunk->polySize; ++j)
 				*elements++ = TESS_UNDEF;
 		}
 	}
 }
 
-void OutputContours( TESStesselator *tess, TESSmesh *mesh, int vertexSize )
+static void RunOutputChunks( TESSscheduler *sched, OutputChunk *chunks, int chunkCount, TessTaskFunc *func )
 {
-	TESSface *f = 0;
-	TESShalfEdge *edge = 0;
-	TESShalfEdge *start = 0;
-	TESSreal *verts = 0;
-	TESSindex *elements = 0;
-	TESSindex *vertInds = 0;
-	int startVert = 0;
-	int vertCount = 0;
+	TessTaskGroup group;
+	int i;
 
-	tess->vertexCount = 0;
-	tess->elementCount = 0;
+	tessTaskGroupInit( &group );
+	for ( i = 0; i < chunkCount; ++i )
+		tessSchedulerSpawn( sched, &group, &chunks[i].task, func, &chunks[i] );
+	tessSchedulerWait( sched, &group );
+}
+
+/* OutputPolymeshParallel( tess, mesh, ... ) writes the output of
+* OutputPolymesh() using the threads of tess->sched.  The faces are
+* numbered from an array, the vertices numbered by each chunk of faces
+* are counted, and their prefix sums tell where each chunk continues the
+* numbering, so the output is the same as the serial one.  Returns 0 if
+* the output was not written, because there is no scheduler, the output
+* is small, or the work arrays could not be allocated.
+*/
+static int OutputPolymeshParallel( TESStesselator *tess, TESSmesh *mesh, int elementType, int polySize, int vertexSize )
+{
+	TESSscheduler *sched = tess->sched;
+	TESSalloc *alloc = &tess->alloc;
+	TESSface *f, **faces;
+	OutputChunk *chunks;
+	int i, faceCount, chunkCount, perChunk, maxFaceCount;
+	TESSindex vertexCount;
+
+	if ( sched == NULL || sched->threadCount == 0 )
+		return 0;
+
+	faceCount = mesh->insideCount;
+	if ( faceCount < TESS_PARALLEL_OUTPUT_MIN )
+		return 0;
+
+	chunkCount = 4 * (sched->threadCount + 1);
+	perChunk = (faceCount + chunkCount-1) / chunkCount;
+	chunkCount = (faceCount + perChunk-1) / perChunk;
 
+	faces = (TESSface**)alloc->memalloc( alloc->userData, sizeof(TESSface*) * faceCount );
+	chunks = (OutputChunk*)alloc->memalloc( alloc->userData, sizeof(OutputChunk) * chunkCount );
+	if ( faces == NULL || chunks == NULL )
+	{
+		if ( faces != NULL ) alloc->memfree( alloc->userData, faces );
+		if ( chunks != NULL ) alloc->memfree( alloc->userData, chunks );
+		return 0;
+	}
+
+	// Create unique IDs for the faces.
+	faceCount = 0;
 	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
 	{
+		f->n = TESS_UNDEF;
 		if ( !f->inside ) continue;
-
-		start = edge = f->anEdge;
-		do
-		{
-			++tess->vertexCount;
-			edge = edge->Lnext;
-		}
-		while ( edge != start );
-
-		++tess->elementCount;
+		f->n = faceCount;
+		faces[faceCount++] = f;
 	}
 
-	tess->elements = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-													  sizeof(TESSindex) * tess->elementCount * 2 );
-	if (!tess->elements)
+	for ( i = 0; i < chunkCount; ++i )
 	{
-		tess->outOfMemory = 1;
-		return;
+		chunks[i].tess = tess;
+		chunks[i].faces = faces + i * perChunk;
+		chunks[i].count = i < chunkCount-1 ? perChunk : faceCount - i * perChunk;
+		chunks[i].elementType = elementType;
+		chunks[i].polySize = polySize;
+		chunks[i].vertexSize = vertexSize;
 	}
 
-	tess->vertices = (TESSreal*)tess->alloc.memalloc( tess->alloc.userData,
-													  sizeof(TESSreal) * tess->vertexCount * vertexSize );
-	if (!tess->vertices)
+	// Count the vertices each chunk meets first, and number them from
+	// where the previous chunk ends.
+	RunOutputChunks( sched, chunks, chunkCount, CountOutputChunk );
+	vertexCount = 0;
+	for ( i = 0; i < chunkCount; ++i )
 	{
-		tess->outOfMemory = 1;
-		return;
+		chunks[i].vertexBase = vertexCount;
+		vertexCount += chunks[i].vertexCount;
 	}
 
-	tess->vertexIndices = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-														    sizeof(TESSindex) * tess->vertexCount );
-	if (!tess->vertexIndices)
+	tess->elementCount = faceCount;
+	maxFaceCount = elementType == TESS_CONNECTED_POLYGONS ? faceCount * 2 : faceCount;
+	tess->elements = (TESSindex*)alloc->memalloc( alloc->userData, sizeof(TESSindex) * maxFaceCount * polySize );
+	tess->vertexCount = vertexCount;
+	tess->vertices = (TESSreal*)alloc->memalloc( alloc->userData, sizeof(TESSreal) * tess->vertexCount * vertexSize );
+	tess->vertexIndices = (TESSindex*)alloc->memalloc( alloc->userData, sizeof(TESSindex) * tess->vertexCount );
+	if ( !tess->elements || !tess->vertices || !tess->vertexIndices )
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+	else
 	{
-		tess->outOfMemory = 1;
-		return;
+		// The elements refer to vertices numbered by other chunks,
+		// so they are written once all the vertices are done.
+		RunOutputChunks( sched, chunks, chunkCount, WriteOutputVertices );
+		RunOutputChunks( sched, chunks, chunkCount, WriteOutputElements );
 	}
 
-	verts = tess->vertices;
-	elements = tess->elements;
-	vertInds = tess->vertexIndices;
+	alloc->memfree( alloc->userData, chunks );
+	alloc->memfree( alloc->userData, faces );
+	return 1;
+}
 
-	startVert = 0;
+typedef struct FaceKey
+{
+	unsigned int regionKey;	/* Morton code of the centre of the region */
+	unsigned int key;		/* Morton code of the centre of the face */
+	TESSindex region;
+	TESSface *face;
+} FaceKey;
+
+static int CompareFaceKeys( const void *a, const void *b )
+{
+	const FaceKey *ka = (const FaceKey*)a;
+	const FaceKey *kb = (const FaceKey*)b;
+	if ( ka->regionKey != kb->regionKey ) return ka->regionKey < kb->regionKey ? -1 : 1;
+	if ( ka->region != kb->region ) return ka->region < kb->region ? -1 : 1;
+	if ( ka->key != kb->key ) return ka->key < kb->key ? -1 : 1;
+	return 0;
+}
+
+static TESSreal Clamp01( TESSreal x )
+{
+	return x < 0 ? 0 : (x > 1 ? 1 : x);
+}
+
+/* Interleaves the bits of the 16-bit grid coordinates of (s,t) within the
+* bounds of the projected input. */
+static unsigned int MortonCode( TESStesselator *tess, TESSreal s, TESSreal t )
+{
+	TESSreal w = tess->bmax[0] - tess->bmin[0];
+	TESSreal h = tess->bmax[1] - tess->bmin[1];
+	TESSreal u = w > 0 ? (s - tess->bmin[0]) / w : 0;
+	TESSreal r = h > 0 ? (t - tess->bmin[1]) / h : 0;
+	unsigned int x, y, code = 0;
+	int i;
+
+	x = (unsigned int)(Clamp01( u ) * 65535);
+	y = (unsigned int)(Clamp01( r ) * 65535);
+
+	for ( i = 0; i < 16; ++i )
+		code |= ((x >> i) & 1) << (2*i) | ((y >> i) & 1) << (2*i+1);
+	return code;
+}
+
+/* GroupFaces( tess, mesh ) moves the inside faces to the end of the face
+* list, ordered by the Morton code of their region and then by their own,
+* and builds tess->groups for the runs of faces from the same region.  The
+* faces are output in list order, so element i is the i-th sorted face.
+* The faces must be tagged by TagRegions().  Returns 0 if out of memory.
+*/
+static int GroupFaces( TESStesselator *tess, TESSmesh *mesh )
+{
+	TESSalloc *alloc = &tess->alloc;
+	TESSface *f, *fPrev, *fNext;
+	TESShalfEdge *e;
+	TESSvertex *v;
+	TESSgroup *group;
+	FaceKey *keys;
+	TESSreal *bounds, *b, s, t;
+	int i, j, n, faceCount = mesh->insideCount, regionCount = 0;
+
+	if ( faceCount == 0 )
+		return 1;
+	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
+		if ( f->inside && (int)f->n >= regionCount )
+			regionCount = (int)f->n + 1;
+
+	keys = (FaceKey*)alloc->memalloc( alloc->userData, sizeof(FaceKey) * faceCount );
+	bounds = (TESSreal*)alloc->memalloc( alloc->userData, sizeof(TESSreal) * 4 * regionCount );
+	if ( keys == NULL || bounds == NULL )
+	{
+		if ( keys != NULL ) alloc->memfree( alloc->userData, keys );
+		if ( bounds != NULL ) alloc->memfree( alloc->userData, bounds );
+		return 0;
+	}
+
+	// Bounds of the regions, and the centres of the faces.
+	for ( i = 0; i < regionCount; ++i )
+	{
+		bounds[i*4+0] = tess->bmax[0]; bounds[i*4+1] = tess->bmax[1];
+		bounds[i*4+2] = tess->bmin[0]; bounds[i*4+3] = tess->bmin[1];
+	}
+	i = 0;
+	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
+	{
+		if ( !f->inside ) continue;
+		b = &bounds[f->n*4];
+		s = t = 0;
+		n = 0;
+		e = f->anEdge;
+		do
+		{
+			v = e->Org;
+			if ( v->s < b[0] ) b[0] = v->s;
+			if ( v->t < b[1] ) b[1] = v->t;
+			if ( v->s > b[2] ) b[2] = v->s;
+			if ( v->t > b[3] ) b[3] = v->t;
+			s += v->s;
+			t += v->t;
+			n++;
+			e = e->Lnext;
+		}
+		while ( e != f->anEdge );
+		keys[i].key = MortonCode( tess, s / n, t / n );
+		keys[i].region = f->n;
+		keys[i].face = f;
+		i++;
+	}
+	for ( i = 0; i < faceCount; ++i )
+	{
+		b = &bounds[keys[i].region*4];
+		keys[i].regionKey = MortonCode( tess, (b[0] + b[2]) / 2, (b[1] + b[3]) / 2 );
+	}
+	alloc->memfree( alloc->userData, bounds );
+
+	qsort( keys, faceCount, sizeof(FaceKey), CompareFaceKeys );
+
+	tess->groupCount = 1;
+	for ( i = 1; i < faceCount; ++i )
+		if ( keys[i].region != keys[i-1].region )
+			tess->groupCount++;
+	tess->groups = (TESSgroup*)alloc->memalloc( alloc->userData, sizeof(TESSgroup) * tess->groupCount );
+	if ( tess->groups == NULL )
+	{
+		tess->groupCount = 0;
+		alloc->memfree( alloc->userData, keys );
+		return 0;
+	}
+
+	group = tess->groups - 1;
+	for ( i = 0; i < faceCount; ++i )
+	{
+		f = keys[i].face;
+
+		// Move the face to the end of the list.
+		fPrev = f->prev;
+		fNext = f->next;
+		fPrev->next = fNext;
+		fNext->prev = fPrev;
+		fPrev = mesh->fHead.prev;
+		f->prev = fPrev;
+		f->next = &mesh->fHead;
+		fPrev->next = f;
+		mesh->fHead.prev = f;
+
+		if ( i == 0 || keys[i].region != keys[i-1].region )
+		{
+			group++;
+			group->firstElement = i;
+			group->elementCount = 0;
+			v = f->anEdge->Org;
+			for ( j = 0; j < 3; ++j )
+				group->bmin[j] = group->bmax[j] = v->coords[j];
+		}
+		group->elementCount++;
+		e = f->anEdge;
+		do
+		{
+			v = e->Org;
+			for ( j = 0; j < 3; ++j )
+			{
+				if ( v->coords[j] < group->bmin[j] ) group->bmin[j] = v->coords[j];
+				if ( v->coords[j] > group->bmax[j] ) group->bmax[j] = v->coords[j];
+			}
+			e = e->Lnext;
+		}
+		while ( e != f->anEdge );
+	}
+
+	alloc->memfree( alloc->userData, keys );
+	return 1;
+}
+
+void OutputPolymesh( TESStesselator *tess, TESSmesh *mesh, int elementType, int polySize, int vertexSize )
+{
+	TESSvertex* v = 0;
+	TESSface* f = 0;
+	TESShalfEdge* edge = 0;
+	int maxFaceCount = 0;
+	int maxVertexCount = 0;
+	int faceCount = 0;
+	int faceVerts, i;
+	TESSindex *elements = 0;
+	TESSreal *vert;
+
+	// Assume that the input data is triangles now.
+	// Try to merge as many polygons as possible
+	if (polySize > 3)
+	{
+		if (!tessMeshMergeConvexFaces( mesh, polySize ))
+		{
+			tess->error = TESS_ERROR_OUT_OF_MEMORY;
+			return;
+		}
+	}
+
+	if ( tess->groupedOutput && !GroupFaces( tess, mesh ) )
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	// Mark unused
+	for ( v = mesh->vHead.next; v != &mesh->vHead; v = v->next )
+		v->n = TESS_UNDEF;
+
+	if ( OutputPolymeshParallel( tess, mesh, elementType, polySize, vertexSize ) )
+		return;
+
+	// The mesh counts its faces and vertices, so the arrays can be
+	// allocated up front and filled in a single pass over the faces.
+	// Not all mesh vertices need to be used by the inside faces.
+	maxFaceCount = mesh->insideCount;
+	tess->elementCount = maxFaceCount;
+	if (elementType == TESS_CONNECTED_POLYGONS)
+		maxFaceCount *= 2;
+	tess->elements = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
+													  sizeof(TESSindex) * maxFaceCount * polySize );
+	if (!tess->elements)
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	tess->vertices = (TESSreal*)tess->alloc.memalloc( tess->alloc.userData,
+													 sizeof(TESSreal) * mesh->vertexCount * vertexSize );
+	if (!tess->vertices)
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	tess->vertexIndices = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
+														    sizeof(TESSindex) * mesh->vertexCount );
+	if (!tess->vertexIndices)
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	// Create unique IDs for all vertices and faces, and output them
+	// as they are met.
+	elements = tess->elements;
+	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
+	{
+		f->n = TESS_UNDEF;
+		if( !f->inside ) continue;
+
+		// Store polygon
+		edge = f->anEdge;
+		faceVerts = 0;
+		do
+		{
+			v = edge->Org;
+			if ( v->n == TESS_UNDEF )
+			{
+				v->n = maxVertexCount;
+				maxVertexCount++;
+				// Store coordinate
+				vert = &tess->vertices[v->n*vertexSize];
+				vert[0] = v->coords[0];
+				vert[1] = v->coords[1];
+				if ( vertexSize > 2 )
+					vert[2] = v->coords[2];
+				// Store vertex index.
+				tess->vertexIndices[v->n] = v->idx;
+			}
+			*elements++ = v->n;
+			faceVerts++;
+			edge = edge->Lnext;
+		}
+		while (edge != f->anEdge);
+
+		assert( faceVerts <= polySize );
+
+		// Fill unused.
+		for (i = faceVerts; i < polySize; ++i)
+			*elements++ = TESS_UNDEF;
+
+		// The connectivity is stored below, once all faces have IDs.
+		if ( elementType == TESS_CONNECTED_POLYGONS )
+			elements += polySize;
+
+		f->n = faceCount;
+		++faceCount;
+	}
+	assert( faceCount == tess->elementCount );
+
+	tess->vertexCount = maxVertexCount;
+
+	// Store polygon connectivity
+	if ( elementType == TESS_CONNECTED_POLYGONS )
+	{
+		elements = tess->elements;
+		for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
+		{
+			if ( !f->inside ) continue;
+
+			elements += polySize;
+			edge = f->anEdge;
+			faceVerts = 0;
+			do
+			{
+				*elements++ = GetNeighbourFace( edge );
+				faceVerts++;
+				edge = edge->Lnext;
+			}
+			while (edge != f->anEdge);
+			// Fill unused.
+			for (i = faceVerts; i < polySize; ++i)
+				*elements++ = TESS_UNDEF;
+		}
+	}
+}
+
+void OutputContours( TESStesselator *tess, TESSmesh *mesh, int vertexSize )
+{
+	TESSface *f = 0;
+	TESShalfEdge *edge = 0;
+	TESShalfEdge *start = 0;
+	TESSreal *verts = 0;
+	TESSindex *elements = 0;
+	TESSindex *vertInds = 0;
+	int startVert = 0;
+	int vertCount = 0;
+
+	// Only the boundary edges are left, each has an inside face on
+	// exactly one side, so every edge gives one contour vertex.
+	tess->vertexCount = mesh->edgeCount;
+	tess->elementCount = mesh->insideCount;
+
+	tess->elements = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
+													  sizeof(TESSindex) * tess->elementCount * 2 );
+	if (!tess->elements)
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	tess->vertices = (TESSreal*)tess->alloc.memalloc( tess->alloc.userData,
+													  sizeof(TESSreal) * tess->vertexCount * vertexSize );
+	if (!tess->vertices)
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	tess->vertexIndices = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
+														    sizeof(TESSindex) * tess->vertexCount );
+	if (!tess->vertexIndices)
+	{
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return;
+	}
+
+	verts = tess->vertices;
+	elements = tess->elements;
+	vertInds = tess->vertexIndices;
+
+	startVert = 0;
 
 	for ( f = mesh->fHead.next; f != &mesh->fHead; f = f->next )
 	{
@@ -911,27 +1658,245 @@ void OutputContours( TESStesselator *tess, TESSmesh *mesh, int vertexSize )
 
 		startVert += vertCount;
 	}
+	assert( startVert == tess->vertexCount );
 }
 
-void tessAddContour( TESStesselator *tess, int size, const void* vertices,
-					int stride, int numVertices )
+int tessBeginContour( TESStesselator *tess, int vertexCount )
+{
+	if ( tess->mesh == NULL ) {
+		/* First contour since the last tessTesselate() */
+		tess->error = TESS_ERROR_NONE;
+	  	tess->mesh = tessMeshNewMesh( &tess->alloc, vertexCount );
+	}
+ 	if ( tess->mesh == NULL ) {
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		return 0;
+	}
+	return 1;
+}
+
+TESShalfEdge *tessAddContourVertex( TESStesselator *tess, TESShalfEdge *e,
+								   TESSreal x, TESSreal y, TESSreal z, TESSindex idx )
+{
+	/* v - v is NaN for both infinities and NaNs. */
+	if( !(x - x == 0 && y - y == 0 && z - z == 0) ) {
+		tess->error = TESS_ERROR_INVALID_INPUT;
+		return NULL;
+	}
+
+	if( e == NULL ) {
+		/* Make a self-loop (one vertex, one edge). */
+		e = tessMeshMakeEdge( tess->mesh );
+		if ( e == NULL ) {
+			tess->error = TESS_ERROR_OUT_OF_MEMORY;
+			return NULL;
+		}
+		if ( !tessMeshSplice( tess->mesh, e, e->Sym ) ) {
+			tess->error = TESS_ERROR_OUT_OF_MEMORY;
+			return NULL;
+		}
+	} else {
+		/* Create a new vertex and edge which immediately follow e
+		* in the ordering around the left face.
+		*/
+		if ( tessMeshSplitEdge( tess->mesh, e ) == NULL ) {
+			tess->error = TESS_ERROR_OUT_OF_MEMORY;
+			return NULL;
+		}
+		e = e->Lnext;
+	}
+
+	/* The new vertex is now e->Org. */
+	e->Org->coords[0] = x;
+	e->Org->coords[1] = y;
+	e->Org->coords[2] = z;
+	/* Store the insertion number so that the vertex can be later recognized. */
+	e->Org->idx = idx;
+
+	/* The winding of an edge says how the winding number changes as we
+	* cross from the edge''s right face to its left face.  We add the
+	* vertices in such an order that a CCW contour will add +1 to
+	* the winding number of the region inside the contour.
+	*/
+	e->winding = tess->reverseContours ? -1 : 1;
+	e->Sym->winding = tess->reverseContours ? 1 : -1;
+
+	return e;
+}
+
+/* Contours are clipped against the clip rectangle with Sutherland-Hodgman
+* clipping, one rectangle side per stage.  The stages are chained so that
+* each vertex flows through all of them as it arrives, and the result goes
+* straight into the mesh without intermediate buffers.  The parts of a
+* contour outside the rectangle are replaced by runs along its boundary,
+* which keeps the winding number of every point inside the rectangle.
+* Overlapping boundary runs of opposite direction cancel out in the sweep.
+*/
+
+typedef struct ClipStage {
+	TESSreal first[3];
+	TESSreal prev[3];
+	TESSindex firstIdx;
+	int prevInside;
+	int hasFirst;
+} ClipStage;
+
+typedef struct Clipper {
+	TESStesselator *tess;
+	TESShalfEdge *e;
+	ClipStage stage[4];
+} Clipper;
+
+static int ClipInside( const TESSreal *rect, int side, const TESSreal *p )
+{
+	switch( side ) {
+		case 0: return p[0] >= rect[0];
+		case 1: return p[1] >= rect[1];
+		case 2: return p[0] <= rect[2];
+		default: return p[1] <= rect[3];
+	}
+}
+
+static void ClipIntersect( const TESSreal *rect, int side, const TESSreal *a,
+						   const TESSreal *b, TESSreal *out )
+{
+	int axis = side & 1;
+	TESSreal t = (rect[side] - a[axis]) / (b[axis] - a[axis]);
+	out[0] = a[0] + (b[0] - a[0]) * t;
+	out[1] = a[1] + (b[1] - a[1]) * t;
+	out[2] = a[2] + (b[2] - a[2]) * t;
+	/* Snap exactly on the side, so that the boundary runs are straight. */
+	out[axis] = rect[side];
+}
+
+static int ClipPoint( Clipper *clip, int side, const TESSreal *p, TESSindex idx )
+{
+	ClipStage *st;
+	const TESSreal *rect = clip->tess->clipRect;
+	TESSreal isect[3];
+	int inside;
+
+	if( side == 4 ) {
+		clip->e = tessAddContourVertex( clip->tess, clip->e, p[0], p[1], p[2], idx );
+		return clip->e != NULL;
+	}
+
+	st = &clip->stage[side];
+	inside = ClipInside( rect, side, p );
+	if( !st->hasFirst ) {
+		st->first[0] = p[0]; st->first[1] = p[1]; st->first[2] = p[2];
+		st->firstIdx = idx;
+		st->hasFirst = 1;
+	} else if( inside != st->prevInside ) {
+		ClipIntersect( rect, side, st->prev, p, isect );
+		if ( !ClipPoint( clip, side+1, isect, TESS_UNDEF )) return 0;
+	}
+	if( inside ) {
+		if ( !ClipPoint( clip, side+1, p, idx )) return 0;
+	}
+	st->prev[0] = p[0]; st->prev[1] = p[1]; st->prev[2] = p[2];
+	st->prevInside = inside;
+	return 1;
+}
+
+static int ClipClose( Clipper *clip, int side )
+{
+	ClipStage *st;
+	TESSreal isect[3];
+
+	if( side == 4 )
+		return 1;
+
+	/* Handle the closing edge from the last vertex back to the first. */
+	st = &clip->stage[side];
+	if( st->hasFirst && st->prevInside != ClipInside( clip->tess->clipRect, side, st->first )) {
+		ClipIntersect( clip->tess->clipRect, side, st->prev, st->first, isect );
+		if ( !ClipPoint( clip, side+1, isect, TESS_UNDEF )) return 0;
+	}
+	return ClipClose( clip, side+1 );
+}
+
+void tessSetClipRect( TESStesselator *tess, TESSreal minx, TESSreal miny, TESSreal maxx, TESSreal maxy )
+{
+	tess->clipEnabled = maxx > minx && maxy > miny;
+	tess->clipRect[0] = minx;
+	tess->clipRect[1] = miny;
+	tess->clipRect[2] = maxx;
+	tess->clipRect[3] = maxy;
+
+	if ( tess->capture != NULL )
+		tessCaptureClipRect( tess, tess->clipRect );
+}
+
+/* AddContour() is tessAddContour() without capturing the call, for
+* tessAddContours() which captures its contours itself. */
+static void AddContour( TESStesselator *tess, int size, const void* vertices,
+					   int stride, int numVertices )
 {
 	const unsigned char *src = (const unsigned char*)vertices;
+	const TESSreal *rect = tess->clipRect;
 	TESShalfEdge *e;
+	TESSreal bmin[2], bmax[2];
+	TESSindex base;
+	Clipper clip;
 	int i;
 
-	if ( tess->mesh == NULL )
-	  	tess->mesh = tessMeshNewMesh( &tess->alloc );
- 	if ( tess->mesh == NULL ) {
-		tess->outOfMemory = 1;
+	if ( !tessBeginContour( tess, numVertices ) )
 		return;
-	}
 
 	if ( size < 2 )
 		size = 2;
 	if ( size > 3 )
 		size = 3;
 
+	if ( tess->clipEnabled && numVertices > 0 )
+	{
+		const TESSreal* coords = (const TESSreal*)src;
+		bmin[0] = bmax[0] = coords[0];
+		bmin[1] = bmax[1] = coords[1];
+		for( i = 1; i < numVertices; ++i )
+		{
+			coords = (const TESSreal*)(src + i*stride);
+			if ( coords[0] < bmin[0] ) bmin[0] = coords[0];
+			if ( coords[1] < bmin[1] ) bmin[1] = coords[1];
+			if ( coords[0] > bmax[0] ) bmax[0] = coords[0];
+			if ( coords[1] > bmax[1] ) bmax[1] = coords[1];
+		}
+
+		if ( bmin[0] >= rect[2] || bmin[1] >= rect[3] || bmax[0] <= rect[0] || bmax[1] <= rect[1] )
+		{
+			/* Completely outside, the contour cannot contribute to the inside. */
+			tess->vertexIndexCounter += numVertices;
+			return;
+		}
+
+		if ( bmin[0] < rect[0] || bmin[1] < rect[1] || bmax[0] > rect[2] || bmax[1] > rect[3] )
+		{
+			/* Crosses the rectangle, clip. */
+			base = tess->vertexIndexCounter;
+			tess->vertexIndexCounter += numVertices;
+
+			clip.tess = tess;
+			clip.e = NULL;
+			for( i = 0; i < 4; ++i )
+				clip.stage[i].hasFirst = 0;
+
+			for( i = 0; i < numVertices; ++i )
+			{
+				const TESSreal* coords = (const TESSreal*)src;
+				TESSreal p[3];
+				src += stride;
+				p[0] = coords[0];
+				p[1] = coords[1];
+				p[2] = size > 2 ? coords[2] : 0;
+				if ( !ClipPoint( &clip, 0, p, base + i ) )
+					return;
+			}
+			ClipClose( &clip, 0 );
+			return;
+		}
+	}
+
 	e = NULL;
 
 	for( i = 0; i < numVertices; ++i )
@@ -939,46 +1904,143 @@ void tessAddContour( TESStesselator *tess, int size, const void* vertices,
 		const TESSreal* coords = (const TESSreal*)src;
 		src += stride;
 
-		if( e == NULL ) {
-			/* Make a self-loop (one vertex, one edge). */
-			e = tessMeshMakeEdge( tess->mesh );
-			if ( e == NULL ) {
-				tess->outOfMemory = 1;
-				return;
-			}
-			if ( !tessMeshSplice( tess->mesh, e, e->Sym ) ) {
-				tess->outOfMemory = 1;
-				return;
-			}
-		} else {
-			/* Create a new vertex and edge which immediately follow e
-			* in the ordering around the left face.
-			*/
-			if ( tessMeshSplitEdge( tess->mesh, e ) == NULL ) {
-				tess->outOfMemory = 1;
-				return;
+		e = tessAddContourVertex( tess, e, coords[0], coords[1], size > 2 ? coords[2] : 0,
+								  tess->vertexIndexCounter++ );
+		if ( e == NULL )
+			return;
+	}
+}
+
+void tessAddContour( TESStesselator *tess, int size, const void* vertices,
+					int stride, int numVertices )
+{
+	if ( tess->capture != NULL )
+		tessCaptureContour( tess, size, vertices, stride, numVertices );
+	AddContour( tess, size, vertices, stride, numVertices );
+}
+
+/* Inputs with fewer vertices are added on the calling thread. */
+#define TESS_PARALLEL_INPUT_MIN	8192
+
+typedef struct ContourChunk {
+	/* A copy of the tesselator which builds its own mesh, so that
+	* tessAddContour() can be used as is. */
+	TESStesselator tess;
+	const unsigned char *vertices;
+	const int *counts;
+	int count;
+	int size;
+	int stride;
+	TessTask task;
+} ContourChunk;
+
+static void AddContourChunk( void *data )
+{
+	ContourChunk *chunk = (ContourChunk*)data;
+	const unsigned char *src = chunk->vertices;
+	int i;
+
+	for( i = 0; i < chunk->count; ++i ) {
+		AddContour( &chunk->tess, chunk->size, src, chunk->stride, chunk->counts[i] );
+		src += chunk->counts[i] * chunk->stride;
+	}
+}
+
+void tessAddContours( TESStesselator *tess, int size, const void* vertices,
+					  int stride, const int* counts, int contourCount )
+{
+	const unsigned char *src = (const unsigned char*)vertices;
+	TESSscheduler *sched = tess->sched;
+	ContourChunk *chunks;
+	TessTaskGroup group;
+	int i, j, n, total, target, chunkCount;
+
+	total = 0;
+	for( i = 0; i < contourCount; ++i ) {
+		if ( tess->capture != NULL )
+			tessCaptureContour( tess, size, src + total * stride, stride, counts[i] );
+		total += counts[i];
+	}
+
+
+	chunks = NULL;
+	chunkCount = 0;
+	if ( sched != NULL && sched->threadCount > 0 && total >= TESS_PARALLEL_INPUT_MIN ) {
+		target = total / (4 * (sched->threadCount + 1));
+		for( i = 0, n = 0; i < contourCount; ++i ) {
+			n += counts[i];
+			if( n >= target || i == contourCount-1 ) {
+				chunkCount++;
+				n = 0;
 			}
-			e = e->Lnext;
 		}
+		if ( chunkCount > 1 )
+			chunks = (ContourChunk*)tess->alloc.memalloc( tess->alloc.userData, sizeof(ContourChunk) * chunkCount );
+	}
 
-		/* The new vertex is now e->Org. */
-		e->Org->coords[0] = coords[0];
-		e->Org->coords[1] = coords[1];
-		if ( size > 2 )
-			e->Org->coords[2] = coords[2];
-		else
-			e->Org->coords[2] = 0;
-		/* Store the insertion number so that the vertex can be later recognized. */
-		e->Org->idx = tess->vertexIndexCounter++;
-
-		/* The winding of an edge says how the winding number changes as we
-		* cross from the edge''s right face to its left face.  We add the
-		* vertices in such an order that a CCW contour will add +1 to
-		* the winding number of the region inside the contour.
-		*/
-        e->winding = tess->reverseContours ? -1 : 1;
-        e->Sym->winding = tess->reverseContours ? 1 : -1;
+	/* Creates the mesh of the tesselator, so the copies share nothing
+	* that is created on demand.  The chunks add their vertices to meshes
+	* of their own. */
+	if ( !tessBeginContour( tess, chunks == NULL ? total : 0 ) ) {
+		if ( chunks != NULL )
+			tess->alloc.memfree( tess->alloc.userData, chunks );
+		return;
 	}
+
+	if ( chunks == NULL ) {
+		for( i = 0; i < contourCount; ++i ) {
+			AddContour( tess, size, src, stride, counts[i] );
+			src += counts[i] * stride;
+		}
+		return;
+	}
+
+	/* Each chunk builds a mesh from consecutive contours, numbering its
+	* vertices from where the previous chunk ends.  All the copies are made
+	* before the first chunk runs, as the running chunks count their
+	* allocations in *tess. */
+	for( i = 0, j = 0; j < chunkCount; ++j ) {
+		ContourChunk *chunk = &chunks[j];
+		chunk->tess = *tess;
+		chunk->tess.capture = NULL;
+		chunk->vertices = src;
+		chunk->counts = counts + i;
+		chunk->count = 0;
+		chunk->size = size;
+		chunk->stride = stride;
+		for( n = 0; i < contourCount && (n < target || j == chunkCount-1); ++i ) {
+			n += counts[i];
+			src += counts[i] * stride;
+			chunk->count++;
+		}
+		tess->vertexIndexCounter += n;
+		chunk->tess.mesh = tessMeshNewMesh( &tess->alloc, n );
+		if ( chunk->tess.mesh == NULL )
+			tess->error = TESS_ERROR_OUT_OF_MEMORY;
+	}
+	tessTaskGroupInit( &group );
+	for( j = 0; j < chunkCount; ++j ) {
+		if ( chunks[j].tess.mesh != NULL )
+			tessSchedulerSpawn( sched, &group, &chunks[j].task, AddContourChunk, &chunks[j] );
+	}
+	tessSchedulerWait( sched, &group );
+
+	/* Splicing the lists in order gives the same mesh as adding the
+	* contours one by one. */
+	for( j = 0; j < chunkCount; ++j ) {
+		if ( chunks[j].tess.mesh == NULL )
+			continue;
+		tess->mesh = tessMeshUnion( &tess->alloc, tess->mesh, chunks[j].tess.mesh );
+		if ( tess->error == TESS_ERROR_NONE )
+			tess->error = chunks[j].tess.error;
+	}
+
+	tess->alloc.memfree( tess->alloc.userData, chunks );
+}
+
+void tessSetScheduler( TESStesselator *tess, TESSscheduler* sched )
+{
+	tess->sched = sched;
 }
 
 void tessSetOption( TESStesselator *tess, int option, int value )
@@ -991,14 +2053,64 @@ void tessSetOption( TESStesselator *tess, int option, int value )
 	case TESS_REVERSE_CONTOURS:
 		tess->reverseContours = value > 0 ? 1 : 0;
 		break;
+	case TESS_AUTO_SWEEP_DIRECTION:
+		tess->autoSweepDirection = value > 0 ? 1 : 0;
+		break;
+	case TESS_GROUPED_OUTPUT:
+		tess->groupedOutput = value > 0 ? 1 : 0;
+		break;
+	case TESS_PHASE_TIMINGS:
+		tess->phaseTimings = value > 0 ? 1 : 0;
+		break;
 	}
+
+	if ( tess->capture != NULL )
+		tessCaptureOption( tess, option, value );
 }
 
 
-int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
-				  int polySize, int vertexSize, const TESSreal* normal )
+/* CountMeshBuckets( tess, mesh ) records the usage of the mesh and region
+* allocators before the mesh is deleted, and CountAllocCalls( tess ) the
+* allocator calls made since the previous tessTesselate(), for
+* tessGetAllocStats().
+*/
+static void CountMeshBuckets( TESStesselator *tess, TESSmesh *mesh )
+{
+	TESSbucketStats *stats = tess->allocStats.buckets;
+
+	if ( mesh != NULL ) {
+		bucketAllocStats( mesh->edgeBucket, &stats[TESS_BUCKETS_MESH_EDGES] );
+		bucketAllocStats( mesh->vertexBucket, &stats[TESS_BUCKETS_MESH_VERTICES] );
+		bucketAllocStats( mesh->faceBucket, &stats[TESS_BUCKETS_MESH_FACES] );
+	}
+	bucketAllocStats( tess->regionPool, &stats[TESS_BUCKETS_REGIONS] );
+}
+
+static void CountAllocCalls( TESStesselator *tess )
+{
+	tess->allocStats.allocCount = (int)tess->allocCount;
+	tess->allocStats.reallocCount = (int)tess->reallocCount;
+	tess->allocStats.freeCount = (int)tess->freeCount;
+	tess->allocCount = 0;
+	tess->reallocCount = 0;
+	tess->freeCount = 0;
+}
+
+/* PhaseTime( tess ) reads the clock for the phase times of Tesselate(),
+* only if they are asked for.
+*/
+static double PhaseTime( TESStesselator *tess )
+{
+	if ( !tess->phaseTimings && tess->tracer == NULL )
+		return 0;
+	return tessTimeSeconds();
+}
+
+static int Tesselate( TESStesselator *tess, int windingRule, int elementType,
+					 int polySize, int vertexSize, const TESSreal* normal )
 {
 	TESSmesh *mesh;
+	double t0, t1, tc = 0;
 	int rc = 1;
 
 	if (tess->vertices != NULL) {
@@ -1013,9 +2125,17 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 		tess->alloc.memfree( tess->alloc.userData, tess->vertexIndices );
 		tess->vertexIndices = 0;
 	}
+	if (tess->groups != NULL) {
+		tess->alloc.memfree( tess->alloc.userData, tess->groups );
+		tess->groups = 0;
+	}
+	tess->groupCount = 0;
 
 	tess->vertexIndexCounter = 0;
 
+	memset( &tess->stats, 0, sizeof(tess->stats) );
+	memset( &tess->allocStats, 0, sizeof(tess->allocStats) );
+
 	if (normal)
 	{
 		tess->normal[0] = normal[0];
@@ -1030,21 +2150,37 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 	if (vertexSize > 3)
 		vertexSize = 3;
 
-	if (setjmp(tess->env) != 0) {
-		/* come back here if out of memory */
+	if (!tess->mesh)
+	{
 		return 0;
 	}
 
-	if (!tess->mesh)
+	if (windingRule < TESS_WINDING_ODD || windingRule > TESS_WINDING_ABS_GEQ_TWO
+		|| elementType < TESS_POLYGONS || elementType > TESS_BOUNDARY_CONTOURS
+		|| (elementType != TESS_BOUNDARY_CONTOURS && polySize < 3))
 	{
-		return 0;
+		if (tess->error == TESS_ERROR_NONE)
+			tess->error = TESS_ERROR_INVALID_INPUT;
+	}
+	if (tess->error != TESS_ERROR_NONE)
+	{
+		/* the contours could not be added, or the parameters are invalid */
+		goto fail;
 	}
 
+	tess->stats.inputVertexCount = tess->mesh->vertexCount;
+	t0 = PhaseTime( tess );
+
 	/* Determine the polygon normal and project vertices onto the plane
 	* of the polygon.
 	*/
 	tessProjectPolygon( tess );
 
+	t1 = PhaseTime( tess );
+	tess->stats.projectTime = t1 - t0;
+	TESS_TRACE_EVENT( tess, "project", t0, t1 );
+	t0 = t1;
+
 	/* tessComputeInterior( tess ) computes the planar arrangement specified
 	* by the given contours, and further subdivides this arrangement
 	* into regions.  Each region is marked "inside" if it belongs
@@ -1052,10 +2188,14 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 	* Each interior region is guaranteed be monotone.
 	*/
 	if ( !tessComputeInterior( tess ) ) {
-		longjmp(tess->env,1);  /* could've used a label */
+		goto fail;
 	}
 
 	mesh = tess->mesh;
+	tess->stats.sweepVertexCount = mesh->vertexCount;
+	t1 = PhaseTime( tess );
+	tess->stats.sweepTime = t1 - t0;
+	t0 = t1;
 
 	/* If the user wants only the boundary contours, we throw away all edges
 	* except those which separate the interior from the exterior.
@@ -1063,15 +2203,29 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 	*/
 	if (elementType == TESS_BOUNDARY_CONTOURS) {
 		rc = tessMeshSetWindingNumber( mesh, 1, TRUE );
+		TESS_TRACE_END( tess, "boundary", t0 );
 	} else {
-		rc = tessMeshTessellateInterior( mesh );
-		if (rc != 0 && tess->processCDT != 0)
-			tessMeshRefineDelaunay( mesh, &tess->alloc );
+		if ( tess->groupedOutput )
+			TagRegions( mesh );
+		rc = TessellateInterior( tess, mesh );
+		TESS_TRACE_END( tess, "triangulate", t0 );
+		if (rc != 0 && tess->processCDT != 0) {
+			TESS_TRACE_BEGIN( tess, tc );
+			rc = tessMeshRefineDelaunay( mesh, &tess->alloc, &tess->allocStats.buckets[TESS_BUCKETS_CDT_NODES] );
+			TESS_TRACE_END( tess, "cdt", tc );
+		}
+	}
+	if (rc == 0) {
+		tess->error = TESS_ERROR_OUT_OF_MEMORY;
+		goto fail;
 	}
-	if (rc == 0) longjmp(tess->env,1);  /* could've used a label */
 
 	tessMeshCheckMesh( mesh );
 
+	t1 = PhaseTime( tess );
+	tess->stats.tessellateTime = t1 - t0;
+	t0 = t1;
+
 	if (elementType == TESS_BOUNDARY_CONTOURS) {
 		OutputContours( tess, mesh, vertexSize );     /* output contours */
 	}
@@ -1080,12 +2234,61 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 		OutputPolymesh( tess, mesh, elementType, polySize, vertexSize );     /* output polygons */
 	}
 
+	t1 = PhaseTime( tess );
+	tess->stats.outputTime = t1 - t0;
+	TESS_TRACE_EVENT( tess, "output", t0, t1 );
+
+	CountMeshBuckets( tess, mesh );
 	tessMeshDeleteMesh( &tess->alloc, mesh );
 	tess->mesh = NULL;
+	CountAllocCalls( tess );
 
-	if (tess->outOfMemory)
+	if (tess->error != TESS_ERROR_NONE)
 		return 0;
 	return 1;
+
+fail:
+	/* The mesh may be left half-way through an operation, discard it. */
+	CountMeshBuckets( tess, tess->mesh );
+	tessMeshDeleteMesh( &tess->alloc, tess->mesh );
+	tess->mesh = NULL;
+	CountAllocCalls( tess );
+	return 0;
+}
+
+int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
+				  int polySize, int vertexSize, const TESSreal* normal )
+{
+	double t0;
+	int rc;
+
+	if ( tess->capture == NULL && tess->tracer == NULL )
+		return Tesselate( tess, windingRule, elementType, polySize, vertexSize, normal );
+
+	if ( tess->tracer != NULL )
+		tess->traceCall = tessTraceNextCall( tess->tracer );
+	t0 = tessTimeSeconds();
+	rc = Tesselate( tess, windingRule, elementType, polySize, vertexSize, normal );
+	TESS_TRACE_END( tess, "tessTesselate", t0 );
+	if ( tess->capture != NULL )
+		tessCaptureTesselate( tess, windingRule, elementType, polySize, vertexSize, normal,
+							  rc, tessTimeSeconds() - t0 );
+	return rc;
+}
+
+int tessGetError( TESStesselator *tess )
+{
+	return tess->error;
+}
+
+const TESSstats* tessGetStats( TESStesselator *tess )
+{
+	return &tess->stats;
+}
+
+const TESSallocStats* tessGetAllocStats( TESStesselator *tess )
+{
+	return &tess->allocStats;
 }
 
 int tessGetVertexCount( TESStesselator *tess )
@@ -1112,3 +2315,13 @@ const int* tessGetElements( TESStesselator *tess )
 {
 	return tess->elements;
 }
+
+int tessGetGroupCount( TESStesselator *tess )
+{
+	return tess->groupCount;
+}
+
+const TESSgroup* tessGetGroups( TESStesselator *tess )
+{
+	return tess->groups;
+}
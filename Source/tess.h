@@ -32,7 +32,6 @@
 #ifndef TESS_H
 #define TESS_H
 
-#include <setjmp.h>
 #include "bucketalloc.h"
 #include "mesh.h"
 #include "dict.h"
@@ -45,12 +44,14 @@ extern "C" {
 
 //typedef struct TESStesselator TESStesselator;
 
+typedef struct TessCapture TessCapture;
+
 struct TESStesselator {
 
 	/*** state needed for collecting the input data ***/
 	TESSmesh	*mesh;		/* stores the input contours, and eventually
 						the tessellation itself */
-	int outOfMemory;
+	int error;		/* TessError, see tessGetError() */
 
 	/*** state needed for projecting onto the sweep plane ***/
 
@@ -63,6 +64,13 @@ struct TESStesselator {
 
 	int processCDT;	/* option to run Constrained Delayney pass. */
 	int reverseContours; /* tessAddContour() will treat CCW contours as CW and vice versa */
+	int autoSweepDirection;	/* option to choose the sweep direction based on the input */
+	int groupedOutput;	/* option to output the polygons grouped by region */
+	int phaseTimings;	/* option to time the phases into stats */
+	int fixedProjection;	/* sUnit and tUnit are given, see tessProjectPolygon() */
+
+	int clipEnabled;	/* clip contours added by tessAddContour() */
+	TESSreal clipRect[4];	/* clip rectangle: minx, miny, maxx, maxy */
     
 	/*** state needed for the line sweep ***/
 	int	windingRule;	/* rule for determining polygon interior */
@@ -70,6 +78,9 @@ struct TESStesselator {
 	Dict *dict;		/* edge dictionary for sweep line */
 	PriorityQ *pq;		/* priority queue of vertex events */
 	TESSvertex *event;		/* current sweep event being processed */
+	unsigned int evalStamp;	/* changes whenever cached edge evaluations
+							become stale (see EdgeLeq) */
+	int activeRegionCount;	/* regions in dict, not counting the sentinels */
 
 	struct BucketAlloc* regionPool;
 
@@ -80,11 +91,55 @@ struct TESStesselator {
 	int vertexCount;
 	TESSindex *elements;
 	int elementCount;
+	TESSgroup *groups;	/* see TESS_GROUPED_OUTPUT, NULL if not grouped */
+	int groupCount;
+
+	TESSalloc alloc;	/* counts the calls and passes them to userAlloc */
+	TESSalloc userAlloc;	/* the allocator given to tessNewTess() */
+	long allocCount;	/* allocator calls since the last tessTesselate(), */
+	long reallocCount;	/* updated atomically as the threads working for */
+	long freeCount;		/* the tesselator share tess->alloc */
+	TESSallocStats allocStats;
+	TESSscheduler *sched;	/* runs parts of the work in parallel, or NULL */
+
+	TESSstats stats;
+	TessCapture *capture;	/* records the calls, see capture.h, or NULL */
+	TESStracer *tracer;		/* records the phases, see trace.h, or NULL */
+	long traceCall;			/* number of the traced tessTesselate() call */
+
+	int poolSlot;	/* slot in the owning TESSpool, or -1 */
+};
+
+/* tessBeginContour( tess, vertexCount ) makes sure the input mesh exists
+* before contour vertices are added.  "vertexCount" is the number of
+* vertices about to be added, or 0 if not known, which sizes the mesh
+* buckets if they are adaptive.  Returns 0 if out of memory.
+*
+* tessAddContourVertex( tess, e, x, y, z, idx ) appends a vertex after the
+* half-edge "e" of the contour being built, or starts a new contour if "e"
+* is NULL.  Returns the half-edge whose origin is the new vertex, or NULL if
+* out of memory or the vertex is not finite (tess->error tells which).
+* These are shared by tessAddContour() and the front ends which generate
+* contours directly into the mesh (see offset.c).
+*/
+int tessBeginContour( TESStesselator *tess, int vertexCount );
+TESShalfEdge *tessAddContourVertex( TESStesselator *tess, TESShalfEdge *e,
+								   TESSreal x, TESSreal y, TESSreal z, TESSindex idx );
+
+/* tessProjectPolygon( tess ) determines the polygon normal and projects
+* the vertices onto the sweep plane.  If tess->fixedProjection is set, the
+* given sUnit and tUnit are used as is, which lets parts of an input be
+* tessellated separately with exactly the same projection (see batch.c).
+*/
+void tessProjectPolygon( TESStesselator *tess );
 
-	TESSalloc alloc;
+/* tessResetTess( tess ) discards pending contours and the output, and
+* restores the options to their defaults.  The region pool is kept.
+*/
+void tessResetTess( TESStesselator *tess );
 
-	jmp_buf env;			/* place to jump to when memAllocs fail */
-};
+/* tessDefaultAlloc() returns the heap allocator used when none is given. */
+TESSalloc* tessDefaultAlloc( void );
 
 #ifdef __cplusplus
 };
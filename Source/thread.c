@@ -0,0 +1,135 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+/* clock_gettime() and CLOCK_MONOTONIC are POSIX, not C99. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "thread.h"
+
+#if defined(_WIN32)
+
+#include <process.h>
+
+static unsigned __stdcall ThreadMain( void *p )
+{
+	TessThread *thread = (TessThread*)p;
+	thread->func( thread->arg );
+	return 0;
+}
+
+int tessThreadCreate( TessThread *thread, TessThreadFunc *func, void *arg )
+{
+	thread->func = func;
+	thread->arg = arg;
+	thread->handle = (HANDLE)_beginthreadex( NULL, 0, ThreadMain, thread, 0, NULL );
+	return thread->handle != 0;
+}
+
+void tessThreadJoin( TessThread *thread )
+{
+	WaitForSingleObject( thread->handle, INFINITE );
+	CloseHandle( thread->handle );
+}
+
+void tessMutexInit( TessMutex *m ) { InitializeCriticalSection( m ); }
+void tessMutexDestroy( TessMutex *m ) { DeleteCriticalSection( m ); }
+void tessMutexLock( TessMutex *m ) { EnterCriticalSection( m ); }
+void tessMutexUnlock( TessMutex *m ) { LeaveCriticalSection( m ); }
+
+void tessCondInit( TessCond *c ) { InitializeConditionVariable( c ); }
+void tessCondDestroy( TessCond *c ) { (void)c; }
+void tessCondWait( TessCond *c, TessMutex *m ) { SleepConditionVariableCS( c, m, INFINITE ); }
+void tessCondSignal( TessCond *c ) { WakeConditionVariable( c ); }
+void tessCondBroadcast( TessCond *c ) { WakeAllConditionVariable( c ); }
+
+int tessProcessorCount( void )
+{
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+double tessTimeSeconds( void )
+{
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency( &freq );
+	QueryPerformanceCounter( &count );
+	return (double)count.QuadPart / (double)freq.QuadPart;
+}
+
+#else
+
+#include <unistd.h>
+#include <time.h>
+
+static void *ThreadMain( void *p )
+{
+	TessThread *thread = (TessThread*)p;
+	thread->func( thread->arg );
+	return NULL;
+}
+
+int tessThreadCreate( TessThread *thread, TessThreadFunc *func, void *arg )
+{
+	thread->func = func;
+	thread->arg = arg;
+	return pthread_create( &thread->handle, NULL, ThreadMain, thread ) == 0;
+}
+
+void tessThreadJoin( TessThread *thread )
+{
+	pthread_join( thread->handle, NULL );
+}
+
+void tessMutexInit( TessMutex *m ) { pthread_mutex_init( m, NULL ); }
+void tessMutexDestroy( TessMutex *m ) { pthread_mutex_destroy( m ); }
+void tessMutexLock( TessMutex *m ) { pthread_mutex_lock( m ); }
+void tessMutexUnlock( TessMutex *m ) { pthread_mutex_unlock( m ); }
+
+void tessCondInit( TessCond *c ) { pthread_cond_init( c, NULL ); }
+void tessCondDestroy( TessCond *c ) { pthread_cond_destroy( c ); }
+void tessCondWait( TessCond *c, TessMutex *m ) { pthread_cond_wait( c, m ); }
+void tessCondSignal( TessCond *c ) { pthread_cond_signal( c ); }
+void tessCondBroadcast( TessCond *c ) { pthread_cond_broadcast( c ); }
+
+int tessProcessorCount( void )
+{
+	long n = sysconf( _SC_NPROCESSORS_ONLN );
+	return n > 0 ? (int)n : 1;
+}
+
+double tessTimeSeconds( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+#endif
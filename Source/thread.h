@@ -0,0 +1,111 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Minimal portable threading layer used by the scheduler: threads, mutexes,
+* condition variables and a few atomic operations on longs.
+*/
+
+#if defined(_WIN32)
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+typedef CRITICAL_SECTION TessMutex;
+typedef CONDITION_VARIABLE TessCond;
+
+#define tessAtomicAdd(p, v)			(InterlockedExchangeAdd( (p), (v) ) + (v))
+#define tessAtomicCas(p, old, val)	(InterlockedCompareExchange( (p), (val), (old) ) == (old))
+#define tessAtomicLoad(p)			InterlockedCompareExchange( (p), 0, 0 )
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t TessMutex;
+typedef pthread_cond_t TessCond;
+
+#define tessAtomicAdd(p, v)			__sync_add_and_fetch( (p), (v) )
+#define tessAtomicCas(p, old, val)	__sync_bool_compare_and_swap( (p), (old), (val) )
+#define tessAtomicLoad(p)			__sync_add_and_fetch( (p), 0 )
+
+#endif
+
+/* Storage class for thread local variables. */
+#if defined(_MSC_VER)
+#define TESS_THREAD_LOCAL	__declspec(thread)
+#else
+#define TESS_THREAD_LOCAL	__thread
+#endif
+
+typedef void TessThreadFunc( void *arg );
+
+/* The thread object must stay at the same address while the thread runs. */
+typedef struct TessThread {
+#if defined(_WIN32)
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+	TessThreadFunc *func;
+	void *arg;
+} TessThread;
+
+int tessThreadCreate( TessThread *thread, TessThreadFunc *func, void *arg );
+void tessThreadJoin( TessThread *thread );
+
+void tessMutexInit( TessMutex *m );
+void tessMutexDestroy( TessMutex *m );
+void tessMutexLock( TessMutex *m );
+void tessMutexUnlock( TessMutex *m );
+
+void tessCondInit( TessCond *c );
+void tessCondDestroy( TessCond *c );
+void tessCondWait( TessCond *c, TessMutex *m );
+void tessCondSignal( TessCond *c );
+void tessCondBroadcast( TessCond *c );
+
+/* Returns number of logical processors, at least 1. */
+int tessProcessorCount( void );
+
+/* Returns monotonic time in seconds from an arbitrary start. */
+double tessTimeSeconds( void );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
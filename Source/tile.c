@@ -0,0 +1,297 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008) 
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+** 
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software. 
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+** 
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <math.h>
+#include "tess.h"
+#include "scheduler.h"
+
+/* Tile grid tessellation.  The contours of the layer are binned to the
+* tiles their bounds overlap in one pass, then each tile is tessellated as
+* a separate task with its own tesselator, clipping the binned contours to
+* the tile rectangle (see tessSetClipRect()).
+*/
+
+typedef struct TessTileJob {
+	int size;
+	const unsigned char *vertices;
+	int stride;
+	const int *contours;
+	int windingRule;
+	int elementType;
+	int polySize;
+	int vertexSize;
+	const TESSreal *normal;
+} TessTileJob;
+
+typedef struct TessTile {
+	TESStileset *ts;
+	TESStesselator *tess;
+	int index;
+	int used;		/* tile has output from the last tessTesselateTiles() */
+	int result;
+	TessTask task;
+} TessTile;
+
+struct TESStileset {
+	TESSalloc alloc;
+	TESSreal origin[2];
+	TESSreal tileSize[2];
+	int columns;
+	int rows;
+	TessTile *tiles;
+	int *tileStart;		/* first reference of each tile, columns*rows+1 items */
+	int *refs;			/* contour references, sorted by tile */
+	const TessTileJob *job;
+};
+
+TESStileset* tessNewTileset( TESSalloc* alloc, TESSreal originX, TESSreal originY,
+							 TESSreal tileWidth, TESSreal tileHeight, int columns, int rows )
+{
+	TESStileset *ts;
+	int i, n;
+
+	if( alloc == NULL )
+		alloc = tessDefaultAlloc();
+	if( columns < 1 || rows < 1 || tileWidth <= 0 || tileHeight <= 0 )
+		return 0;
+
+	ts = (TESStileset*)alloc->memalloc( alloc->userData, sizeof(TESStileset) );
+	if( ts == NULL )
+		return 0;
+	ts->alloc = *alloc;
+	ts->origin[0] = originX;
+	ts->origin[1] = originY;
+	ts->tileSize[0] = tileWidth;
+	ts->tileSize[1] = tileHeight;
+	ts->columns = columns;
+	ts->rows = rows;
+	ts->refs = NULL;
+	ts->job = NULL;
+
+	n = columns * rows;
+	ts->tiles = (TessTile*)alloc->memalloc( alloc->userData, sizeof(TessTile) * n );
+	ts->tileStart = (int*)alloc->memalloc( alloc->userData, sizeof(int) * (n+1) );
+	if( ts->tiles == NULL || ts->tileStart == NULL ) {
+		if( ts->tiles != NULL ) alloc->memfree( alloc->userData, ts->tiles );
+		if( ts->tileStart != NULL ) alloc->memfree( alloc->userData, ts->tileStart );
+		alloc->memfree( alloc->userData, ts );
+		return 0;
+	}
+	for( i = 0; i < n; ++i ) {
+		ts->tiles[i].ts = ts;
+		ts->tiles[i].tess = NULL;
+		ts->tiles[i].index = i;
+		ts->tiles[i].used = 0;
+		ts->tiles[i].result = 0;
+	}
+
+	return ts;
+}
+
+void tessDeleteTileset( TESStileset* ts )
+{
+	int i, n;
+
+	if( ts == NULL ) return;
+
+	n = ts->columns * ts->rows;
+	for( i = 0; i < n; ++i ) {
+		if( ts->tiles[i].tess != NULL )
+			tessDeleteTess( ts->tiles[i].tess );
+	}
+	if( ts->refs != NULL )
+		ts->alloc.memfree( ts->alloc.userData, ts->refs );
+	ts->alloc.memfree( ts->alloc.userData, ts->tileStart );
+	ts->alloc.memfree( ts->alloc.userData, ts->tiles );
+	ts->alloc.memfree( ts->alloc.userData, ts );
+}
+
+/* Returns the range of tiles overlapped by the bounds, or 0 if none. */
+static int TileRange( const TESStileset *ts, const TESSreal *bmin, const TESSreal *bmax, int *range )
+{
+	int i;
+	for( i = 0; i < 2; ++i ) {
+		int count = i == 0 ? ts->columns : ts->rows;
+		TESSreal lo = floorf( (bmin[i] - ts->origin[i]) / ts->tileSize[i] );
+		TESSreal hi = floorf( (bmax[i] - ts->origin[i]) / ts->tileSize[i] );
+		if( hi < 0 || lo >= count )
+			return 0;
+		range[i*2+0] = lo < 0 ? 0 : (int)lo;
+		range[i*2+1] = hi >= count ? count-1 : (int)hi;
+	}
+	return 1;
+}
+
+static void TesselateTile( void *data )
+{
+	TessTile *tile = (TessTile*)data;
+	TESStileset *ts = tile->ts;
+	const TessTileJob *job = ts->job;
+	TESStesselator *tess = tile->tess;
+	int col = tile->index % ts->columns;
+	int row = tile->index / ts->columns;
+	TESSreal x = ts->origin[0] + col * ts->tileSize[0];
+	TESSreal y = ts->origin[1] + row * ts->tileSize[1];
+	int i, c;
+
+	tessSetClipRect( tess, x, y, x + ts->tileSize[0], y + ts->tileSize[1] );
+	for( i = ts->tileStart[tile->index]; i < ts->tileStart[tile->index+1]; ++i ) {
+		c = ts->refs[i];
+		/* Make the vertex indices refer to the vertices of the layer. */
+		tess->vertexIndexCounter = job->contours[c*2];
+		tessAddContour( tess, job->size, job->vertices + job->contours[c*2] * job->stride,
+						job->stride, job->contours[c*2+1] );
+	}
+	tile->result = tessTesselate( tess, job->windingRule, job->elementType,
+								  job->polySize, job->vertexSize, job->normal );
+}
+
+int tessTesselateTiles( TESStileset* ts, TESSscheduler* sched,
+						int size, const void* vertices, int stride,
+						const int* contours, int contourCount,
+						int windingRule, int elementType, int polySize, int vertexSize,
+						const TESSreal* normal )
+{
+	const unsigned char *src = (const unsigned char*)vertices;
+	TessTileJob job;
+	TessTaskGroup group;
+	TESSreal *bounds;
+	int range[4];
+	int n = ts->columns * ts->rows;
+	int i, j, x, y, refCount, result = 1;
+
+	/* Bin the contours to the tiles.  The bounds are stored on the first
+	* pass which counts the references, and reused on the second. */
+	bounds = (TESSreal*)ts->alloc.memalloc( ts->alloc.userData, sizeof(TESSreal) * 4 * (contourCount > 0 ? contourCount : 1) );
+	if( bounds == NULL )
+		return 0;
+
+	for( i = 0; i <= n; ++i )
+		ts->tileStart[i] = 0;
+
+	for( i = 0; i < contourCount; ++i ) {
+		TESSreal *b = &bounds[i*4];
+		const TESSreal *v;
+		int count = contours[i*2+1];
+		if( count < 3 ) {
+			b[0] = b[2] = 1; b[1] = b[3] = 0;	/* empty */
+			continue;
+		}
+		v = (const TESSreal*)(src + contours[i*2] * stride);
+		b[0] = b[2] = v[0];
+		b[1] = b[3] = v[1];
+		for( j = 1; j < count; ++j ) {
+			v = (const TESSreal*)(src + (contours[i*2] + j) * stride);
+			if( v[0] < b[0] ) b[0] = v[0];
+			if( v[1] < b[1] ) b[1] = v[1];
+			if( v[0] > b[2] ) b[2] = v[0];
+			if( v[1] > b[3] ) b[3] = v[1];
+		}
+		if( !TileRange( ts, &b[0], &b[2], range ) )
+			continue;
+		for( y = range[2]; y <= range[3]; ++y )
+			for( x = range[0]; x <= range[1]; ++x )
+				ts->tileStart[y * ts->columns + x + 1]++;
+	}
+
+	for( i = 0; i < n; ++i )
+		ts->tileStart[i+1] += ts->tileStart[i];
+	refCount = ts->tileStart[n];
+
+	if( ts->refs != NULL )
+		ts->alloc.memfree( ts->alloc.userData, ts->refs );
+	ts->refs = (int*)ts->alloc.memalloc( ts->alloc.userData, sizeof(int) * (refCount > 0 ? refCount : 1) );
+	if( ts->refs == NULL ) {
+		ts->alloc.memfree( ts->alloc.userData, bounds );
+		return 0;
+	}
+
+	/* Fill in the references, using tileStart as insertion point,
+	* which leaves it shifted by one tile. */
+	for( i = 0; i < contourCount; ++i ) {
+		TESSreal *b = &bounds[i*4];
+		if( b[0] > b[2] || !TileRange( ts, &b[0], &b[2], range ) )
+			continue;
+		for( y = range[2]; y <= range[3]; ++y )
+			for( x = range[0]; x <= range[1]; ++x )
+				ts->refs[ts->tileStart[y * ts->columns + x]++] = i;
+	}
+	for( i = n; i > 0; --i )
+		ts->tileStart[i] = ts->tileStart[i-1];
+	ts->tileStart[0] = 0;
+
+	ts->alloc.memfree( ts->alloc.userData, bounds );
+
+	job.size = size;
+	job.vertices = src;
+	job.stride = stride;
+	job.contours = contours;
+	job.windingRule = windingRule;
+	job.elementType = elementType;
+	job.polySize = polySize;
+	job.vertexSize = vertexSize;
+	job.normal = normal;
+	ts->job = &job;
+
+	tessTaskGroupInit( &group );
+	for( i = 0; i < n; ++i ) {
+		TessTile *tile = &ts->tiles[i];
+		tile->used = ts->tileStart[i+1] > ts->tileStart[i];
+		tile->result = 0;
+		if( !tile->used )
+			continue;
+		if( tile->tess == NULL ) {
+			tile->tess = tessNewTess( &ts->alloc );
+			if( tile->tess == NULL ) {
+				tile->used = 0;
+				result = 0;
+				continue;
+			}
+		}
+		tessSchedulerSpawn( sched, &group, &tile->task, TesselateTile, tile );
+	}
+	tessSchedulerWait( sched, &group );
+	ts->job = NULL;
+
+	for( i = 0; i < n; ++i ) {
+		if( ts->tiles[i].used && !ts->tiles[i].result )
+			result = 0;
+	}
+
+	return result;
+}
+
+TESStesselator* tessGetTile( const TESStileset* ts, int column, int row )
+{
+	const TessTile *tile;
+	if( column < 0 || column >= ts->columns || row < 0 || row >= ts->rows )
+		return 0;
+	tile = &ts->tiles[row * ts->columns + column];
+	return tile->used && tile->result ? tile->tess : 0;
+}
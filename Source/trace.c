@@ -0,0 +1,150 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+**
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include "trace.h"
+
+typedef struct TraceEvent {
+	const char *name;	/* static string */
+	double start, end;	/* seconds, see tessTimeSeconds() */
+	long call;			/* number of the tessTesselate() call */
+	long thread;
+} TraceEvent;
+
+struct TESStracer {
+	TESSalloc alloc;
+	TraceEvent *events;
+	long maxEvents;
+	long eventCount;	/* events reserved, may exceed maxEvents */
+	long callCount;
+	double origin;		/* time of creation, timestamps are relative to it */
+};
+
+/* Threads are numbered in the order they first record an event. */
+static long traceThreadCount = 0;
+static TESS_THREAD_LOCAL long traceThread = 0;
+
+TESStracer* tessNewTracer( TESSalloc* alloc, int maxEvents )
+{
+	TESStracer *tracer;
+
+	if( alloc == NULL )
+		alloc = tessDefaultAlloc();
+	if( maxEvents < 1 )
+		maxEvents = 1;
+
+	tracer = (TESStracer*)alloc->memalloc( alloc->userData, sizeof(TESStracer) );
+	if( tracer == NULL )
+		return 0;
+	tracer->alloc = *alloc;
+	tracer->events = (TraceEvent*)alloc->memalloc( alloc->userData, sizeof(TraceEvent) * maxEvents );
+	if( tracer->events == NULL ) {
+		alloc->memfree( alloc->userData, tracer );
+		return 0;
+	}
+	tracer->maxEvents = maxEvents;
+	tracer->eventCount = 0;
+	tracer->callCount = 0;
+	tracer->origin = tessTimeSeconds();
+	return tracer;
+}
+
+void tessDeleteTracer( TESStracer* tracer )
+{
+	TESSalloc alloc;
+
+	if( tracer == NULL )
+		return;
+	alloc = tracer->alloc;
+	alloc.memfree( alloc.userData, tracer->events );
+	alloc.memfree( alloc.userData, tracer );
+}
+
+void tessSetTracer( TESStesselator *tess, TESStracer* tracer )
+{
+	tess->tracer = tracer;
+}
+
+long tessTraceNextCall( TESStracer *tracer )
+{
+	return tessAtomicAdd( &tracer->callCount, 1 );
+}
+
+void tessTraceEvent( TESStracer *tracer, const char *name, long call, double start, double end )
+{
+	TraceEvent *ev;
+	long i;
+
+	i = tessAtomicAdd( &tracer->eventCount, 1 ) - 1;
+	if( i >= tracer->maxEvents )
+		return;
+	if( traceThread == 0 )
+		traceThread = tessAtomicAdd( &traceThreadCount, 1 );
+	ev = &tracer->events[i];
+	ev->name = name;
+	ev->start = start;
+	ev->end = end;
+	ev->call = call;
+	ev->thread = traceThread;
+}
+
+int tessWriteTrace( TESStracer* tracer, const char* path )
+{
+	FILE *fp;
+	TraceEvent *ev;
+	long i, count, dropped;
+	int ok;
+
+	fp = fopen( path, "w" );
+	if( fp == NULL )
+		return 0;
+
+	count = tracer->eventCount;
+	dropped = 0;
+	if( count > tracer->maxEvents ) {
+		dropped = count - tracer->maxEvents;
+		count = tracer->maxEvents;
+	}
+
+	/* Complete ("X") events, timestamps and durations in microseconds. */
+	fprintf( fp, "{\"traceEvents\":[\n" );
+	for( i = 0; i < count; ++i ) {
+		ev = &tracer->events[i];
+		fprintf( fp, "{\"name\":\"%s\",\"cat\":\"tess\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+				 "\"pid\":1,\"tid\":%ld,\"args\":{\"call\":%ld}}%s\n",
+				 ev->name, (ev->start - tracer->origin) * 1e6, (ev->end - ev->start) * 1e6,
+				 ev->thread, ev->call, i + 1 < count ? "," : "" );
+	}
+	fprintf( fp, "],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"droppedEvents\":%ld}}\n", dropped );
+
+	ok = !ferror( fp );
+	if( fclose( fp ) != 0 )
+		ok = 0;
+	return ok;
+}
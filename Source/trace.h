@@ -0,0 +1,74 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+**
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "tess.h"
+#include "thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A tracer collects timed events of the phases of tessTesselate() (see
+* tessSetTracer()), which are written out in the Chrome trace event format.
+* Events are appended to a fixed buffer by any number of threads; the ones
+* which do not fit are counted and dropped.
+*
+* The hooks cost a single test of tess->tracer when tracing is off.  The
+* start time of a phase is only taken when tracing is on, so the variable
+* holding it should be initialized to keep the compiler quiet.
+*/
+
+#define TESS_TRACE_BEGIN(tess, start) \
+	do { if ( (tess)->tracer != NULL ) (start) = tessTimeSeconds(); } while(0)
+
+#define TESS_TRACE_END(tess, name, start) \
+	do { \
+		if ( (tess)->tracer != NULL ) \
+			tessTraceEvent( (tess)->tracer, (name), (tess)->traceCall, (start), tessTimeSeconds() ); \
+	} while(0)
+
+/* Records a phase which was timed anyway, e.g. for TESSstats. */
+#define TESS_TRACE_EVENT(tess, name, start, end) \
+	do { \
+		if ( (tess)->tracer != NULL ) \
+			tessTraceEvent( (tess)->tracer, (name), (tess)->traceCall, (start), (end) ); \
+	} while(0)
+
+/* Returns a new number for a traced tessTesselate() call. */
+long tessTraceNextCall( TESStracer *tracer );
+
+void tessTraceEvent( TESStracer *tracer, const char *name, long call, double start, double end );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
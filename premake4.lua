@@ -22,6 +22,49 @@ solution "libtess2"
 		files { "Source/*.c" }
 		targetdir("Build")
 
+	-- the same library built as a single translation unit
+	project "tess2_amalgamated"
+		language "C"
+		kind "StaticLib"
+		includedirs { "Include", "Source" }
+		files { "Source/amalgamation/tesselator_all.c" }
+		targetdir("Build")
+
+	-- command line benchmark
+	project "bench"
+		kind "ConsoleApp"
+		language "C"
+		links { "tess2" }
+		files { "Example/bench.c" }
+		includedirs { "Include" }
+		targetdir("Build")
+
+		configuration { "linux" }
+			 links { "m", "pthread" }
+
+	project "bench_amalgamated"
+		kind "ConsoleApp"
+		language "C"
+		links { "tess2_amalgamated" }
+		files { "Example/bench.c" }
+		includedirs { "Include" }
+		targetdir("Build")
+
+		configuration { "linux" }
+			 links { "m", "pthread" }
+
+	-- headless tesselation tool for profiling and reproducing issues
+	project "tesstool"
+		kind "ConsoleApp"
+		language "C"
+		links { "tess2" }
+		files { "Example/tesstool.c", "Contrib/nanosvg.c" }
+		includedirs { "Include", "Contrib" }
+		targetdir("Build")
+
+		configuration { "linux" }
+			 links { "m", "pthread" }
+
 	-- more dynamic example
 	project "example"
 		kind "ConsoleApp"
@@ -33,7 +76,7 @@ solution "libtess2"
 	 
 		configuration { "linux" }
 			 linkoptions { "`pkg-config --libs glfw3`" }
-			 links { "GL", "GLU", "m", "GLEW" }
+			 links { "GL", "GLU", "m", "GLEW", "pthread" }
 			 defines { "NANOVG_GLEW" }
 
 		configuration { "windows" }